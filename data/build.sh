@@ -1,6 +1,6 @@
 cd ..
 mkdir build
 cd build
-cmake . .. -DOpenCV_DIR=/home/nuzhny/work/libraries/opencv/rel -DUSE_OCV_BGFG=ON -DUSE_OCV_KCF=ON -DUSE_OCV_UKF=ON -DSILENT_WORK=OFF -DBUILD_EXAMPLES=ON -DBUILD_ASYNC_DETECTOR=ON -DBUILD_CARS_COUNTING=ON -DBUILD_YOLO_LIB=OFF -DBUILD_YOLO_TENSORRT=OFF
+cmake . .. -DOpenCV_DIR=/home/nuzhny/work/libraries/opencv/rel -DUSE_OCV_BGFG=ON -DUSE_OCV_KCF=ON -DSILENT_WORK=OFF -DBUILD_EXAMPLES=ON -DBUILD_ASYNC_DETECTOR=ON -DBUILD_CARS_COUNTING=ON -DBUILD_YOLO_LIB=OFF -DBUILD_YOLO_TENSORRT=OFF
 make -j4
 
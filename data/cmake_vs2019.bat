@@ -5,7 +5,6 @@ cmake.exe . ..  -G "Visual Studio 16 2019" -A "x64" ^
           -DOpenCV_DIR=C:/work/libraries/opencv/opencv_64_cuda ^
           -DUSE_OCV_BGFG=ON ^
           -DUSE_OCV_KCF=ON  ^
-          -DUSE_OCV_UKF=ON  ^
           -DSILENT_WORK=OFF ^
           -DBUILD_EXAMPLES=ON ^
           -DBUILD_ASYNC_DETECTOR=ON ^
@@ -46,6 +46,8 @@ bool BackgroundSubtract::Init(const config_t& config)
                 }
             }
             m_modelVibe = std::make_unique<vibe::VIBE>(m_channels, params[0], params[1], params[2], params[3], params[4]);
+            if (m_executor)
+                m_modelVibe->SetExecutor(m_executor);
             break;
         }
 
@@ -313,3 +315,13 @@ void BackgroundSubtract::ResetModel(const cv::UMat& img, const cv::Rect& roiRect
 		m_modelVibe->ResetModel(GetImg(img).getMat(cv::ACCESS_READ), roiRect);
 	}
 }
+
+//----------------------------------------------------------------------
+//
+//----------------------------------------------------------------------
+void BackgroundSubtract::SetExecutor(std::shared_ptr<ParallelExecutor> executor)
+{
+	m_executor = executor;
+	if (m_modelVibe)
+		m_modelVibe->SetExecutor(executor);
+}
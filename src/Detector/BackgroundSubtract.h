@@ -1,6 +1,7 @@
 #pragma once
 
 #include "defines.h"
+#include "ParallelExecutor.h"
 #include "vibe_src/vibe.hpp"
 #include "Subsense/BackgroundSubtractorSuBSENSE.h"
 #include "Subsense/BackgroundSubtractorLOBSTER.h"
@@ -34,6 +35,8 @@ public:
     void Subtract(const cv::UMat& image, cv::UMat& foreground);
 
 	void ResetModel(const cv::UMat& img, const cv::Rect& roiRect);
+
+	void SetExecutor(std::shared_ptr<ParallelExecutor> executor);
 	
 	int m_channels = 1;
 	BGFG_ALGS m_algType = BGFG_ALGS::ALG_MOG2;
@@ -45,5 +48,7 @@ private:
 
 	cv::UMat m_rawForeground;
 
+	std::shared_ptr<ParallelExecutor> m_executor;
+
 	cv::UMat GetImg(const cv::UMat& image);
 };
@@ -93,5 +93,9 @@ BaseDetector* CreateDetector(
         delete detector;
         detector = nullptr;
     }
+    else if (auto executor = CreateExecutor(config))
+    {
+        detector->SetExecutor(executor);
+    }
     return detector;
 }
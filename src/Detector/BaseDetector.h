@@ -2,6 +2,7 @@
 
 #include <memory>
 #include "defines.h"
+#include "ParallelExecutor.h"
 
 ///
 /// \brief The BaseDetector class
@@ -14,6 +15,7 @@ public:
     /// \param frame
     ///
     BaseDetector(const cv::UMat& frame)
+        : m_executor(CreateExecutor(tracking::ExecutorOpenMP))
     {
         m_minObjectSize.width = std::max(5, frame.cols / 100);
         m_minObjectSize.height = m_minObjectSize.width;
@@ -60,6 +62,15 @@ public:
         m_minObjectSize = minObjectSize;
     }
 
+    ///
+    /// \brief SetExecutor
+    /// \param executor - parallel loops of the detector, OpenMPExecutor by default
+    ///
+    virtual void SetExecutor(std::shared_ptr<ParallelExecutor> executor)
+    {
+        m_executor = executor;
+    }
+
     ///
     /// \brief GetDetects
     /// \return
@@ -94,9 +105,7 @@ public:
         cv::addWeighted(m_motionMap, alpha, m_normFor, 1 - alpha, 0, m_motionMap);
 
         const int chans = frame.channels();
-		const int height = frame.rows;
-#pragma omp parallel for
-        for (int y = 0; y < height; ++y)
+        m_executor->ParallelFor(0, frame.rows, 16, [&](ptrdiff_t y)
         {
             uchar* imgPtr = frame.ptr(y);
             const float* moPtr = reinterpret_cast<float*>(m_motionMap.ptr(y));
@@ -109,7 +118,7 @@ public:
                 imgPtr += chans;
                 ++moPtr;
             }
-        }
+        });
     }
 
 protected:
@@ -123,6 +132,8 @@ protected:
 
 	std::set<objtype_t> m_classesWhiteList;
 
+    std::shared_ptr<ParallelExecutor> m_executor;
+
     std::vector<cv::Rect> GetCrops(float maxCropRatio, cv::Size netSize, cv::Size imgSize) const
     {
         std::vector<cv::Rect> crops;
@@ -108,9 +108,7 @@ void MotionDetector::CalcMotionMap(cv::Mat& frame)
 
 	const int chans = frame.channels();
 
-	const int height = frame.rows;
-#pragma omp parallel for
-	for (int y = 0; y < height; ++y)
+	m_executor->ParallelFor(0, frame.rows, 16, [&](ptrdiff_t y)
 	{
 		uchar* imgPtr = frame.ptr(y);
 		float* moPtr = reinterpret_cast<float*>(m_motionMap.ptr(y));
@@ -123,5 +121,15 @@ void MotionDetector::CalcMotionMap(cv::Mat& frame)
 			imgPtr += chans;
 			++moPtr;
 		}
-	}
+	});
+}
+
+///
+/// \brief MotionDetector::SetExecutor
+/// \param executor
+///
+void MotionDetector::SetExecutor(std::shared_ptr<ParallelExecutor> executor)
+{
+	BaseDetector::SetExecutor(executor);
+	m_backgroundSubst->SetExecutor(executor);
 }
@@ -23,6 +23,8 @@ public:
 
 	void CalcMotionMap(cv::Mat& frame);
 
+	void SetExecutor(std::shared_ptr<ParallelExecutor> executor);
+
 	void ResetModel(const cv::UMat& img, const cv::Rect& roiRect);
 
 private:
@@ -11,7 +11,8 @@ namespace vibe
 		m_pixelNeighbor(pixel_neighbor),
 		m_distanceThreshold(distance_threshold),
 		m_matchingThreshold(matching_threshold),
-		m_updateFactor(update_factor)
+		m_updateFactor(update_factor),
+		m_executor(CreateExecutor(tracking::ExecutorOpenMP))
 	{
 		//srand(0);
 		for (int i = 0; i < RANDOM_BUFFER_SIZE; i++)
@@ -80,10 +81,9 @@ namespace vibe
 			return;
 		}
 
-		int rowsCount = img.rows;
-#pragma omp parallel for
-		for (int i = 0; i < rowsCount; i++)
+		m_executor->ParallelFor(0, img.rows, 16, [&](ptrdiff_t row)
 		{
+			const int i = static_cast<int>(row);
 			const uchar* img_ptr = img.ptr(i);
 			uchar* mask_ptr = m_mask.ptr(i);
 
@@ -139,7 +139,13 @@ namespace vibe
 				img_ptr += m_channels;
 				++mask_ptr;
 			}
-		}
+		});
+	}
+
+	///
+	void VIBE::SetExecutor(std::shared_ptr<ParallelExecutor> executor)
+	{
+		m_executor = executor;
 	}
 
 	///
@@ -4,6 +4,8 @@
 #include <opencv2/core/core.hpp>
 #include <memory>
 
+#include "ParallelExecutor.h"
+
 namespace vibe
 {
     constexpr int RANDOM_BUFFER_SIZE = 65535;
@@ -20,6 +22,8 @@ public:
 
 	void ResetModel(const cv::Mat& img, const cv::Rect& roiRect);
 
+	void SetExecutor(std::shared_ptr<ParallelExecutor> executor);
+
 private:
     size_t m_samples = 20;
     size_t m_channels = 1;
@@ -37,6 +41,8 @@ private:
     unsigned int m_rng[RANDOM_BUFFER_SIZE];
     int m_rngIdx = 0;
 
+    std::shared_ptr<ParallelExecutor> m_executor;
+
     cv::Vec<size_t, 2> getRndNeighbor(int i, int j);
 	void init(const cv::Mat& img);
 };
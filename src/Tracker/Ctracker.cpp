@@ -9,9 +9,32 @@ CTracker::CTracker(const TrackerSettings& settings)
     :
       m_settings(settings),
       m_nextTrackID(0)
+{
+    if (!m_settings.m_executor)
+        m_settings.m_executor = CreateExecutor(tracking::ExecutorOpenMP);
+
+    m_SPCalculator = CreateSPCalculator();
+
+    if (m_settings.m_distType[tracking::DistFeatureCos] > 0.0f)
+    {
+        m_embCalculator = CreateEmbeddingsCalculator(m_settings.m_embeddingsConfig);
+        // Without embeddings the cosine distance is 1 for all pairs and only shrinks the gate: don't use it
+        if (!m_embCalculator)
+        {
+            std::cerr << "DistFeatureCos is disabled: appearance embeddings network was not initialized" << std::endl;
+            m_settings.m_distType[tracking::DistFeatureCos] = 0.0f;
+        }
+    }
+}
+
+///
+/// \brief CTracker::CreateSPCalculator
+/// \return
+///
+std::unique_ptr<ShortPathCalculator> CTracker::CreateSPCalculator() const
 {
     ShortPathCalculator* spcalc = nullptr;
-    SPSettings spSettings = { settings.m_distThres, 12 };
+    SPSettings spSettings = { m_settings.m_distThres, 12 };
     switch (m_settings.m_matchType)
     {
     case tracking::MatchHungrian:
@@ -20,9 +43,15 @@ CTracker::CTracker(const TrackerSettings& settings)
     case tracking::MatchBipart:
         spcalc = new SPBipart(spSettings);
         break;
+    case tracking::MatchSparseJV:
+        spcalc = new SPSparseJV(spSettings);
+        break;
+    case tracking::MatchLAPJV:
+        spcalc = new SPLAPJV(spSettings);
+        break;
     }
     assert(spcalc != nullptr);
-    m_SPCalculator = std::unique_ptr<ShortPathCalculator>(spcalc);
+    return std::unique_ptr<ShortPathCalculator>(spcalc);
 }
 
 ///
@@ -34,6 +63,7 @@ CTracker::~CTracker(void)
 
 ///
 /// \brief CTracker::Update
+/// Frames are equidistant: timestamps are synthesized from fps
 /// \param regions
 /// \param currFrame
 /// \param fps
@@ -42,9 +72,45 @@ void CTracker::Update(const regions_t& regions,
                       cv::UMat currFrame,
                       float fps)
 {
-    UpdateTrackingState(regions, currFrame, fps);
+    double timestamp = 0;
+    if (m_lastTimestampValid && fps > 0)
+        timestamp = m_lastTimestamp + 1. / fps;
 
-    currFrame.copyTo(m_prevFrame);
+    Update(regions, currFrame, fps, timestamp);
+}
+
+///
+/// \brief CTracker::Update
+/// \param regions
+/// \param currFrame
+/// \param fps - nominal frame rate, m_settings.m_dt is the Kalman time step for one frame of this rate
+/// \param timestamp - frame time in seconds
+///
+void CTracker::Update(const regions_t& regions,
+                      cv::UMat currFrame,
+                      float fps,
+                      double timestamp)
+{
+    // Kalman time step from the real elapsed time: dropped frames make it longer, duplicated - zero
+    track_t deltaTime = m_settings.m_dt;
+    if (m_lastTimestampValid && fps > 0)
+        deltaTime = static_cast<track_t>(m_settings.m_dt * std::max(0., timestamp - m_lastTimestamp) * fps);
+    m_lastTimestamp = timestamp;
+    m_lastTimestampValid = true;
+
+    UpdateTrackingState(regions, currFrame, fps, deltaTime);
+
+    // The previous frame is used only for the external trackers initialization on the lost tracks:
+    // copy it only if some track can be lost on the next frame without the already initialized tracker
+    if (m_settings.m_filterGoal == tracking::FilterRect && m_settings.m_lostTrackType != tracking::TrackNone)
+    {
+        if (std::any_of(std::begin(m_tracks), std::end(m_tracks), [](const auto& track) { return track->IsPrevFrameNeeded(); }))
+            currFrame.copyTo(m_prevFrame);
+    }
+    else if (!m_prevFrame.empty())
+    {
+        m_prevFrame.release();
+    }
 }
 
 ///
@@ -52,17 +118,31 @@ void CTracker::Update(const regions_t& regions,
 /// \param regions
 /// \param currFrame
 /// \param fps
+/// \param deltaTime
 ///
 void CTracker::UpdateTrackingState(const regions_t& regions,
                                    cv::UMat currFrame,
-                                   float fps)
+                                   float fps,
+                                   track_t deltaTime)
 {
     const size_t N = m_tracks.size();	// Tracking objects
     const size_t M = regions.size();	// Detections or regions
 
     assignments_t assignment(N, -1); // Assignments regions -> tracks
 
+    // Release the trajectories views of the tracker owned objects: tracks will not copy them on change
+    m_changes.Clear();
+    if (m_settings.m_trackChanges)
+    {
+        for (auto& object : m_objects)
+        {
+            object.second.m_trace = TraceView();
+        }
+    }
+
     std::vector<RegionEmbedding> regionEmbeddings;
+    if (m_settings.m_distType[tracking::DistHist] > 0.0f || m_settings.m_distType[tracking::DistFeatureCos] > 0.0f)
+        CalcRegionEmbeddings(regions, currFrame, regionEmbeddings);
 
     if (!m_tracks.empty())
     {
@@ -70,10 +150,15 @@ void CTracker::UpdateTrackingState(const regions_t& regions,
         distMatrix_t costMatrix(N * M);
         const track_t maxPossibleCost = static_cast<track_t>(currFrame.cols * currFrame.rows);
         track_t maxCost = 0;
-        CreateDistaceMatrix(regions, regionEmbeddings, costMatrix, maxPossibleCost, maxCost, currFrame);
+        CreateDistaceMatrix(regions, regionEmbeddings, costMatrix, m_sparseDistMatrix, maxPossibleCost, maxCost);
 
         // Solving assignment problem (shortest paths)
-        m_SPCalculator->Solve(costMatrix, N, M, assignment, maxCost);
+        if (m_SPCalculator->SparseInput())
+            m_SPCalculator->Solve(m_sparseDistMatrix, assignment, maxCost);
+        else if (m_settings.m_splitAssignment)
+            SolveByComponents(costMatrix, N, M, assignment, maxCost);
+        else
+            m_SPCalculator->Solve(costMatrix, N, M, assignment, maxCost);
 
         // clean assignment from pairs with large distance
         for (size_t i = 0; i < assignment.size(); i++)
@@ -83,25 +168,38 @@ void CTracker::UpdateTrackingState(const regions_t& regions,
 				if (costMatrix[i + assignment[i] * N] > m_settings.m_distThres)
                 {
                     assignment[i] = -1;
-                    m_tracks[i]->SkippedFrames()++;
+                    m_tracksTable.m_skippedFrames[i]++;
                 }
             }
             else
             {
                 // If track have no assigned detect, then increment skipped frames counter.
-                m_tracks[i]->SkippedFrames()++;
+                m_tracksTable.m_skippedFrames[i]++;
             }
         }
 
-        // If track didn't get detects long time, remove it.
+        // If track didn't get detects long time, remove it: the last track is moved to its place
+        const int staticTimeout = cvRound(fps * (m_settings.m_maxStaticTime - m_settings.m_minStaticTime));
         for (size_t i = 0; i < m_tracks.size();)
         {
-            if (m_tracks[i]->SkippedFrames() > m_settings.m_maximumAllowedSkippedFrames ||
-				m_tracks[i]->IsOutOfTheFrame() ||
-                    m_tracks[i]->IsStaticTimeout(cvRound(fps * (m_settings.m_maxStaticTime - m_settings.m_minStaticTime))))
+            if (m_tracksTable.m_skippedFrames[i] > m_settings.m_maximumAllowedSkippedFrames ||
+				m_tracksTable.m_outOfTheFrame[i] ||
+                    m_tracks[i]->IsStaticTimeout(staticTimeout))
             {
-                m_tracks.erase(m_tracks.begin() + i);
-                assignment.erase(assignment.begin() + i);
+                if (m_settings.m_trackChanges)
+                {
+                    m_changes.m_removed.push_back(m_tracks[i]->GetID());
+                    m_objects.erase(m_tracks[i]->GetID());
+                }
+
+                if (i + 1 != m_tracks.size())
+                {
+                    std::swap(m_tracks[i], m_tracks.back());
+                    std::swap(assignment[i], assignment.back());
+                }
+                m_tracks.pop_back();
+                assignment.pop_back();
+                m_tracksTable.SwapAndPop(i);
             }
 			else
 			{
@@ -133,92 +231,269 @@ void CTracker::UpdateTrackingState(const regions_t& regions,
                                                             m_settings.m_useAcceleration,
                                                             m_nextTrackID++,
                                                             m_settings.m_filterGoal == tracking::FilterRect,
-                                                            m_settings.m_lostTrackType));
+                                                            m_settings.m_lostTrackType,
+                                                            m_settings.m_embeddingsGallerySize));
+            m_tracksTable.PushBack(*m_tracks.back());
         }
     }
 
+    // Kalman prediction for all tracks by chunks: one virtual call per chunk instead of one per track
+    const size_t tracksCount = assignment.size();
+    constexpr size_t predictChunk = 64;
+    m_settings.m_executor->ParallelFor(0, static_cast<ptrdiff_t>((tracksCount + predictChunk - 1) / predictChunk), 1, [&](ptrdiff_t chunk)
+    {
+        const size_t from = chunk * predictChunk;
+        const size_t to = std::min(from + predictChunk, tracksCount);
+        for (size_t i = from; i < to; ++i)
+        {
+            m_tracks[i]->SetDeltaTime(deltaTime);
+        }
+        TKalmanFilter::PredictBatch(m_tracksTable.m_filters.data() + from, to - from);
+    });
+
     // Update Kalman Filters state
-    const ptrdiff_t stop_i = static_cast<ptrdiff_t>(assignment.size());
-#pragma omp parallel for
-    for (ptrdiff_t i = 0; i < stop_i; ++i)
+    SharedFrame staticFrame(currFrame);
+    m_settings.m_executor->ParallelFor(0, static_cast<ptrdiff_t>(tracksCount), 1, [&](ptrdiff_t i)
     {
         // If track updated less than one time, than filter state is not correct.
         if (assignment[i] != -1) // If we have assigned detect, then update using its coordinates,
         {
-            m_tracks[i]->SkippedFrames() = 0;
+            m_tracksTable.m_skippedFrames[i] = 0;
             if (regionEmbeddings.empty())
                 m_tracks[i]->Update(regions[assignment[i]],
                         true, m_settings.m_maxTraceLength,
-                        m_prevFrame, currFrame,
+                        m_prevFrame, currFrame, staticFrame,
                         m_settings.m_useAbandonedDetection ? cvRound(m_settings.m_minStaticTime * fps) : 0);
             else
                 m_tracks[i]->Update(regions[assignment[i]], regionEmbeddings[assignment[i]],
                         true, m_settings.m_maxTraceLength,
-                        m_prevFrame, currFrame,
+                        m_prevFrame, currFrame, staticFrame,
                         m_settings.m_useAbandonedDetection ? cvRound(m_settings.m_minStaticTime * fps) : 0);
         }
         else				     // if not continue using predictions
         {
-            m_tracks[i]->Update(CRegion(), false, m_settings.m_maxTraceLength, m_prevFrame, currFrame, 0);
+            m_tracks[i]->Update(CRegion(), false, m_settings.m_maxTraceLength, m_prevFrame, currFrame, staticFrame, 0);
+        }
+        m_tracksTable.Refresh(i, *m_tracks[i]);
+    });
+
+    if (m_settings.m_trackChanges)
+        UpdateObjects();
+}
+
+///
+/// \brief CTracker::UpdateObjects
+/// Refresh the tracker owned objects and the created and updated tracks lists: only tracks with the changed output state are updated
+///
+void CTracker::UpdateObjects()
+{
+    for (const auto& track : m_tracks)
+    {
+        const size_t trackID = track->GetID();
+        auto it = m_objects.find(trackID);
+        if (it == std::end(m_objects))
+        {
+            m_changes.m_created.push_back(trackID);
+            m_objects.emplace(trackID, track->ConstructObject());
+        }
+        else if (track->RefreshObject(it->second))
+        {
+            m_changes.m_updated.push_back(trackID);
         }
     }
 }
 
+///
+/// \brief CTracker::CalcRegionEmbeddings
+/// Calculate descriptors for all regions once per frame
+/// \param regions
+/// \param currFrame
+/// \param regionEmbeddings
+///
+void CTracker::CalcRegionEmbeddings(const regions_t& regions, cv::UMat currFrame, std::vector<RegionEmbedding>& regionEmbeddings)
+{
+    regionEmbeddings.resize(regions.size());
+
+    if (m_embCalculator)
+        m_embCalculator->Calc(currFrame, regions, regionEmbeddings);
+
+    if (m_settings.m_distType[tracking::DistHist] <= 0.0f)
+        return;
+
+    const int bins = 64;
+    std::vector<int> histSize;
+    std::vector<float> ranges;
+    std::vector<int> channels;
+    for (int i = 0, stop = currFrame.channels(); i < stop; ++i)
+    {
+        histSize.push_back(bins);
+        ranges.push_back(0);
+        ranges.push_back(255);
+        channels.push_back(i);
+    }
+
+    const cv::Rect frameRect(0, 0, currFrame.cols, currFrame.rows);
+    m_settings.m_executor->ParallelFor(0, static_cast<ptrdiff_t>(regions.size()), 1, [&](ptrdiff_t j)
+    {
+        cv::Mat& embedding = regionEmbeddings[j].m_hist;
+        embedding.release();
+
+        const cv::Rect roi = regions[j].m_brect & frameRect;
+        if (roi.empty())
+            return;
+
+        cv::Mat hist;
+        std::vector<cv::UMat> regROI = { currFrame(roi) };
+        cv::calcHist(regROI, channels, cv::Mat(), hist, histSize, ranges, false);
+
+        const float* histData = hist.ptr<float>();
+        const size_t histLen = hist.total();
+        float histSum = 0;
+        for (size_t i = 0; i < histLen; ++i)
+        {
+            histSum += histData[i];
+        }
+        if (histSum <= 0)
+            return;
+
+        embedding.create(1, static_cast<int>(histLen), CV_32F);
+        float* embData = embedding.ptr<float>();
+        for (size_t i = 0; i < histLen; ++i)
+        {
+            embData[i] = sqrtf(histData[i] / histSum);
+        }
+    });
+}
+
 ///
 /// \brief CTracker::CreateDistaceMatrix
 /// \param regions
+/// \param regionEmbeddings
 /// \param costMatrix
+/// \param sparseMatrix
 /// \param maxPossibleCost
 /// \param maxCost
 ///
 void CTracker::CreateDistaceMatrix(const regions_t& regions,
-                                   std::vector<RegionEmbedding>& regionEmbeddings,
+                                   const std::vector<RegionEmbedding>& regionEmbeddings,
                                    distMatrix_t& costMatrix,
+                                   SparseDistMatrix& sparseMatrix,
                                    track_t maxPossibleCost,
-                                   track_t& maxCost,
-                                   cv::UMat currFrame)
+                                   track_t& maxCost)
 {
     const size_t N = m_tracks.size();	// Tracking objects
+    const size_t M = regions.size();	// Detections or regions
     maxCost = 0;
 
-	for (size_t i = 0; i < N; ++i)
+    sparseMatrix.Reset(N, M);
+
+    // Pair outside of the gate has distance not less than sum of the geometric distances weights.
+    // If this sum is greater than threshold then the pair will be rejected after assignment and we can skip it.
+    // The gated pairs get maxPossibleCost instead of their real distance, so the assignment is the same as with the dense matrix only up to the gate:
+    // the pairs outside of it are rejected in both cases, but the solver can choose the other pairs because of their changed costs.
+    // With the default weights (0.5 DistJaccard + 0.5 DistHist and m_distThres = 0.8) the gate isn't used
+    const track_t gateWeights = m_settings.m_distType[tracking::DistCenters] + m_settings.m_distType[tracking::DistRects] + m_settings.m_distType[tracking::DistJaccard];
+    const bool useGate = (gateWeights > m_settings.m_distThres) && (maxPossibleCost > m_settings.m_distThres);
+    if (useGate)
+    {
+        m_regionsGrid.Build(regions);
+        std::fill(costMatrix.begin(), costMatrix.end(), maxPossibleCost);
+    }
+    else
+    {
+        m_allRegions.resize(M);
+        std::iota(m_allRegions.begin(), m_allRegions.end(), 0);
+    }
+
+    if (m_distRows.size() < N)
+        m_distRows.resize(N);
+
+    const bool useEllipse = m_settings.m_distType[tracking::DistCenters] > 0.0f || m_settings.m_distType[tracking::DistRects] > 0.0f;
+    if (useEllipse)
+    {
+        m_regionsX.resize(M);
+        m_regionsY.resize(M);
+        for (size_t j = 0; j < M; ++j)
+        {
+            m_regionsX[j] = regions[j].m_rrect.center.x;
+            m_regionsY[j] = regions[j].m_rrect.center.y;
+        }
+    }
+    const bool useJaccard = m_settings.m_distType[tracking::DistJaccard] > 0.0f;
+    if (useJaccard)
+    {
+        m_regionsRects.Clear(M);
+        for (const auto& reg : regions)
+        {
+            m_regionsRects.Add(reg.m_brect);
+        }
+    }
+
+	m_settings.m_executor->ParallelFor(0, static_cast<ptrdiff_t>(N), 4, [&](ptrdiff_t i)
 	{
-		const auto& track = m_tracks[i];
+		const CRegion& lastRegion = m_tracksTable.m_lastRegions[i];
+		DistRow& distRow = m_distRows[i];
+		distRow.m_cols.clear();
+		distRow.m_dists.clear();
+		distRow.m_maxCost = 0;
 
 		// Calc predicted area for track
 		cv::Size_<track_t> minRadius;
 		if (m_settings.m_minAreaRadiusPix < 0)
 		{
-			minRadius.width = m_settings.m_minAreaRadiusK * track->LastRegion().m_rrect.size.width;
-			minRadius.height = m_settings.m_minAreaRadiusK * track->LastRegion().m_rrect.size.height;
+			minRadius.width = m_settings.m_minAreaRadiusK * lastRegion.m_rrect.size.width;
+			minRadius.height = m_settings.m_minAreaRadiusK * lastRegion.m_rrect.size.height;
 		}
 		else
 		{
 			minRadius.width = m_settings.m_minAreaRadiusPix;
 			minRadius.height = m_settings.m_minAreaRadiusPix;
 		}
-		cv::RotatedRect predictedArea = track->CalcPredictionEllipse(minRadius);
+		cv::RotatedRect& predictedArea = m_tracksTable.m_predictionAreas[i];
+		predictedArea = CTrack::CalcPredictionEllipse(m_tracksTable.m_predictionPoints[i], m_tracksTable.m_velocities[i], m_tracksTable.m_positionCovs[i], minRadius);
+
+		const std::vector<int>* rowRegions = &m_allRegions;
+		if (useGate)
+		{
+			m_regionsGrid.Query(m_regionsGrid.GateRect(predictedArea, lastRegion.m_brect, useJaccard), distRow.m_gateRegions);
+			if (distRow.m_gateRegions.size() < M)
+				distRow.m_maxCost = maxPossibleCost;
+			rowRegions = &distRow.m_gateRegions;
+		}
+
+		// Ellipse distances for all row regions at once, they are used by DistCenters and DistRects
+		if (useEllipse)
+		{
+			distRow.m_ellipseDists.resize(rowRegions->size());
+			EllipseGate(predictedArea).Dists(m_regionsX.data(), m_regionsY.data(), rowRegions->data(), rowRegions->size(), distRow.m_ellipseDists.data());
+		}
+		if (useJaccard)
+		{
+			distRow.m_iou.resize(rowRegions->size());
+			CalcIoU(lastRegion.m_brect, m_regionsRects, rowRegions->data(), rowRegions->size(), distRow.m_iou.data());
+		}
 
 		// Calc distance between track and regions
-		for (size_t j = 0; j < regions.size(); ++j)
+		for (size_t k = 0; k < rowRegions->size(); ++k)
 		{
+			const int j = (*rowRegions)[k];
 			const auto& reg = regions[j];
 
 			auto dist = maxPossibleCost;
-			if (m_settings.CheckType(m_tracks[i]->LastRegion().m_type, reg.m_type))
+			if (m_settings.CheckType(lastRegion.m_type, reg.m_type))
 			{
 				dist = 0;
 				size_t ind = 0;
 				if (m_settings.m_distType[ind] > 0.0f && ind == tracking::DistCenters)
 				{
 #if 1
-                    track_t ellipseDist = track->IsInsideArea(reg.m_rrect.center, predictedArea);
+                    track_t ellipseDist = distRow.m_ellipseDists[k];
                     if (ellipseDist > 1)
                         dist += m_settings.m_distType[ind];
                     else
                         dist += ellipseDist * m_settings.m_distType[ind];
 #else
-					dist += m_settings.m_distType[ind] * track->CalcDistCenter(reg);
+					dist += m_settings.m_distType[ind] * m_tracks[i]->CalcDistCenter(reg);
 #endif
 				}
 				++ind;
@@ -226,11 +501,11 @@ void CTracker::CreateDistaceMatrix(const regions_t& regions,
 				if (m_settings.m_distType[ind] > 0.0f && ind == tracking::DistRects)
 				{
 #if 1
-                    track_t ellipseDist = track->IsInsideArea(reg.m_rrect.center, predictedArea);
+                    track_t ellipseDist = distRow.m_ellipseDists[k];
 					if (ellipseDist < 1)
 					{
-						track_t dw = track->WidthDist(reg);
-						track_t dh = track->HeightDist(reg);
+						track_t dw = CTrack::SizeRatio(lastRegion.m_rrect.size.width, reg.m_rrect.size.width);
+						track_t dh = CTrack::SizeRatio(lastRegion.m_rrect.size.height, reg.m_rrect.size.height);
 						dist += m_settings.m_distType[ind] * (1 - (1 - ellipseDist) * (dw + dh) * 0.5f);
 					}
 					else
@@ -239,28 +514,162 @@ void CTracker::CreateDistaceMatrix(const regions_t& regions,
 					}
 					//std::cout << "dist = " << dist << ", ed = " << ellipseDist << ", dw = " << dw << ", dh = " << dh << std::endl;
 #else
-					dist += m_settings.m_distType[ind] * track->CalcDistRect(reg);
+					dist += m_settings.m_distType[ind] * m_tracks[i]->CalcDistRect(reg);
 #endif
 				}
 				++ind;
 
 				if (m_settings.m_distType[ind] > 0.0f && ind == tracking::DistJaccard)
-					dist += m_settings.m_distType[ind] * track->CalcDistJaccard(reg);
+					dist += m_settings.m_distType[ind] * (1 - distRow.m_iou[k]);
 				++ind;
 
 				if (m_settings.m_distType[ind] > 0.0f && ind == tracking::DistHist)
-                {
-                    if (regionEmbeddings.empty())
-                        regionEmbeddings.resize(regions.size());
-                    dist += m_settings.m_distType[ind] * track->CalcDistHist(reg, regionEmbeddings[j].m_hist, currFrame);
-                }
+                    dist += m_settings.m_distType[ind] * m_tracks[i]->CalcDistHist(regionEmbeddings[j]);
+				++ind;
+
+				if (m_settings.m_distType[ind] > 0.0f && ind == tracking::DistFeatureCos)
+                    dist += m_settings.m_distType[ind] * m_tracks[i]->CalcDistFeature(regionEmbeddings[j]);
 				++ind;
 				assert(ind == tracking::DistsCount);
+
+				distRow.m_cols.push_back(j);
+				distRow.m_dists.push_back(dist);
 			}
 
 			costMatrix[i + j * N] = dist;
-			if (dist > maxCost)
-				maxCost = dist;
+			if (dist > distRow.m_maxCost)
+				distRow.m_maxCost = dist;
 		}
+	});
+
+	// Join rows
+	for (size_t i = 0; i < N; ++i)
+	{
+		const DistRow& distRow = m_distRows[i];
+		for (size_t k = 0; k < distRow.m_cols.size(); ++k)
+		{
+			sparseMatrix.Add(distRow.m_cols[k], distRow.m_dists[k]);
+		}
+		sparseMatrix.FinishRow();
+
+		if (distRow.m_maxCost > maxCost)
+			maxCost = distRow.m_maxCost;
 	}
 }
+
+///
+/// \brief CTracker::SolveByComponents
+/// Split the graph with edges track-region (distance <= m_distThres) to the connected components and solve every one independently
+/// \param costMatrix
+/// \param N
+/// \param M
+/// \param assignment
+/// \param maxCost
+///
+void CTracker::SolveByComponents(const distMatrix_t& costMatrix, size_t N, size_t M, assignments_t& assignment, track_t maxCost)
+{
+    // Union-find: tracks are nodes [0, N), regions are [N, N + M)
+    m_componentsParent.resize(N + M);
+    std::iota(m_componentsParent.begin(), m_componentsParent.end(), 0);
+    auto FindRoot = [&](int node)
+    {
+        while (m_componentsParent[node] != node)
+        {
+            m_componentsParent[node] = m_componentsParent[m_componentsParent[node]];
+            node = m_componentsParent[node];
+        }
+        return node;
+    };
+
+    const SparseDistMatrix& sparseMatrix = m_sparseDistMatrix;
+    for (size_t i = 0; i < N; ++i)
+    {
+        for (size_t k = sparseMatrix.m_rowsStart[i]; k < sparseMatrix.m_rowsStart[i + 1]; ++k)
+        {
+            if (sparseMatrix.m_dists[k] > m_settings.m_distThres)
+                continue;
+            int root1 = FindRoot(static_cast<int>(i));
+            int root2 = FindRoot(static_cast<int>(N) + sparseMatrix.m_colsInd[k]);
+            if (root1 != root2)
+                m_componentsParent[root2] = root1;
+        }
+    }
+
+    // Collect tracks and regions for every component
+    size_t blocksCount = 0;
+    m_componentsBlock.assign(N + M, -1);
+    auto GetBlock = [&](int node) -> AssignmentBlock&
+    {
+        int root = FindRoot(node);
+        if (m_componentsBlock[root] < 0)
+        {
+            m_componentsBlock[root] = static_cast<int>(blocksCount++);
+            if (m_assignmentBlocks.size() < blocksCount)
+                m_assignmentBlocks.emplace_back();
+            m_assignmentBlocks[blocksCount - 1].m_tracks.clear();
+            m_assignmentBlocks[blocksCount - 1].m_regions.clear();
+        }
+        return m_assignmentBlocks[m_componentsBlock[root]];
+    };
+    for (size_t i = 0; i < N; ++i)
+    {
+        GetBlock(static_cast<int>(i)).m_tracks.push_back(static_cast<int>(i));
+    }
+    for (size_t j = 0; j < M; ++j)
+    {
+        GetBlock(static_cast<int>(N + j)).m_regions.push_back(static_cast<int>(j));
+    }
+
+    // Solve all components in parallel
+    m_settings.m_executor->ParallelFor(0, static_cast<ptrdiff_t>(blocksCount), 1, [&](ptrdiff_t b)
+    {
+        AssignmentBlock& block = m_assignmentBlocks[b];
+        const size_t bn = block.m_tracks.size();
+        const size_t bm = block.m_regions.size();
+        if (!bn || !bm)
+            return;
+
+        if (bn == 1 || bm == 1)
+        {
+            // Trivial component: one track or one region
+            track_t minDist = std::numeric_limits<track_t>::max();
+            size_t minI = 0;
+            size_t minJ = 0;
+            for (size_t i = 0; i < bn; ++i)
+            {
+                for (size_t j = 0; j < bm; ++j)
+                {
+                    track_t dist = costMatrix[block.m_tracks[i] + block.m_regions[j] * N];
+                    if (dist < minDist)
+                    {
+                        minDist = dist;
+                        minI = i;
+                        minJ = j;
+                    }
+                }
+            }
+            assignment[block.m_tracks[minI]] = block.m_regions[minJ];
+            return;
+        }
+
+        block.m_costMatrix.resize(bn * bm);
+        for (size_t j = 0; j < bm; ++j)
+        {
+            for (size_t i = 0; i < bn; ++i)
+            {
+                block.m_costMatrix[i + j * bn] = costMatrix[block.m_tracks[i] + block.m_regions[j] * N];
+            }
+        }
+        block.m_assignment.assign(bn, -1);
+
+        if (!block.m_SPCalculator)
+            block.m_SPCalculator = CreateSPCalculator();
+        block.m_SPCalculator->Solve(block.m_costMatrix, bn, bm, block.m_assignment, maxCost);
+
+        for (size_t i = 0; i < bn; ++i)
+        {
+            if (block.m_assignment[i] >= 0)
+                assignment[block.m_tracks[i]] = block.m_regions[block.m_assignment[i]];
+        }
+    });
+}
@@ -7,10 +7,17 @@
 #include <numeric>
 #include <map>
 #include <set>
+#include <unordered_map>
 
 #include "defines.h"
 #include "track.h"
 #include "ShortPathCalculator.h"
+#include "SpatialGrid.h"
+#include "EllipseGate.h"
+#include "iou.h"
+#include "ParallelExecutor.h"
+#include "EmbeddingsCalculator.h"
+#include "TracksTable.h"
 
 // ----------------------------------------------------------------------
 
@@ -22,8 +29,20 @@ struct TrackerSettings
     tracking::KalmanType m_kalmanType = tracking::KalmanLinear;
     tracking::FilterGoal m_filterGoal = tracking::FilterCenter;
     tracking::LostTrackType m_lostTrackType = tracking::TrackKCF;
+    ///
+    /// \brief m_matchType
+    /// Assignment algorithm. MatchHungrian and MatchLAPJV minimize the sum of all distances and reject the pairs with distance > m_distThres after it.
+    /// MatchBipart and MatchSparseJV use only the pairs with distance <= m_distThres and every not assigned track costs m_distThres,
+    /// so they can assign less pairs with the smaller sum (903 vs 955 pairs on the benchmark with 1000 objects, tests/AssignmentBenchmark)
+    ///
     tracking::MatchType m_matchType = tracking::MatchHungrian;
 
+	///
+	/// \brief m_distType
+	/// Weights of the distances, their sum is 1.
+	/// The spatial gate (only the regions near the track are compared) is used when DistCenters + DistRects + DistJaccard > m_distThres,
+	/// with the default weights (0.5 DistJaccard + 0.5 DistHist, m_distThres = 0.8) all pairs are compared
+	///
 	std::array<track_t, tracking::DistsCount> m_distType;
 
     ///
@@ -91,6 +110,38 @@ struct TrackerSettings
     ///
     int m_maxStaticTime = 25;
 
+    ///
+    /// \brief m_splitAssignment
+    /// Split tracks and regions to the independent groups and solve assignment problem for every group
+    ///
+    bool m_splitAssignment = true;
+
+    ///
+    /// \brief m_embeddingsConfig
+    /// Appearance embeddings network for tracking::DistFeatureCos: modelBinary, modelConfiguration, inWidth, inHeight, inScaleFactor, meanVal, swapRB, maxBatch
+    /// If the network can't be loaded then CTracker reports it to std::cerr and sets the DistFeatureCos weight to 0,
+    /// so the sum of the other weights is less than 1 and m_distThres is applied to it as is
+    ///
+    config_t m_embeddingsConfig;
+
+    ///
+    /// \brief m_embeddingsGallerySize
+    /// Last embeddings count for the every track
+    ///
+    size_t m_embeddingsGallerySize = 16;
+
+    ///
+    /// \brief m_trackChanges
+    /// Keep the tracker owned objects and the created, updated and removed tracks IDs for CTracker::GetChanges and CTracker::GetTrack
+    ///
+    bool m_trackChanges = false;
+
+    ///
+    /// \brief m_executor
+    /// Tracks and regions parallel loops, it can be shared between trackers. nullptr - OpenMPExecutor
+    ///
+    std::shared_ptr<ParallelExecutor> m_executor;
+
 	///
 	/// \brief m_nearTypes
 	/// Object types that can be matched while tracking
@@ -104,6 +155,7 @@ struct TrackerSettings
 		m_distType[tracking::DistRects] = 0.0f;
 		m_distType[tracking::DistJaccard] = 0.5f;
 		m_distType[tracking::DistHist] = 0.5f;
+		m_distType[tracking::DistFeatureCos] = 0.0f;
 
 		assert(CheckDistance());
 	}
@@ -170,6 +222,27 @@ struct TrackerSettings
 	}
 };
 
+///
+/// \brief The TracksChanges struct
+/// Tracks IDs changed by the last CTracker::Update
+///
+struct TracksChanges
+{
+    std::vector<size_t> m_created;
+    std::vector<size_t> m_updated;
+    std::vector<size_t> m_removed;
+
+    ///
+    /// \brief Clear
+    ///
+    void Clear()
+    {
+        m_created.clear();
+        m_updated.clear();
+        m_removed.clear();
+    }
+};
+
 ///
 /// \brief The CTracker class
 ///
@@ -185,6 +258,7 @@ public:
 	~CTracker(void);
 
     void Update(const regions_t& regions, cv::UMat currFrame, float fps);
+    void Update(const regions_t& regions, cv::UMat currFrame, float fps, double timestamp);
 
     ///
     /// \brief CanGrayFrameToTrack
@@ -234,17 +308,94 @@ public:
 		return tracks;
 	}
 
+    ///
+    /// \brief GetChanges
+    /// Incremental output with TrackerSettings::m_trackChanges: objects of the created and updated tracks are available with GetTrack without copying of all tracks.
+    /// Updated are the tracks with the changed rectangle, velocity, type, confidence, static or out of the frame state.
+    /// The lists are overwritten by the next Update: read them on the thread that calls Update or synchronize with it
+    /// \return Created, updated and removed tracks IDs in the last Update
+    ///
+    const TracksChanges& GetChanges() const
+    {
+        return m_changes;
+    }
+
+    ///
+    /// \brief GetTrack
+    /// Works with TrackerSettings::m_trackChanges
+    /// \param ID
+    /// \return Tracker owned object or nullptr if there is no track with this ID. The pointer and the object trajectory are valid only until the next Update:
+    /// read them on the thread that calls Update or synchronize with it, copy the object to keep it longer
+    ///
+    const TrackingObject* GetTrack(size_t ID) const
+    {
+        auto it = m_objects.find(ID);
+        return (it != std::end(m_objects)) ? &it->second : nullptr;
+    }
+
 private:
     TrackerSettings m_settings;
 
 	tracks_t m_tracks;
+	TracksTable m_tracksTable;
 
     size_t m_nextTrackID;
 
+    TracksChanges m_changes;
+    std::unordered_map<size_t, TrackingObject> m_objects; // Tracker owned objects by the tracks IDs
+    void UpdateObjects();
+
     cv::UMat m_prevFrame;
 
+    double m_lastTimestamp = 0;      // Seconds
+    bool m_lastTimestampValid = false;
+
     std::unique_ptr<ShortPathCalculator> m_SPCalculator;
 
-    void CreateDistaceMatrix(const regions_t& regions, std::vector<RegionEmbedding>& regionEmbeddings, distMatrix_t& costMatrix, track_t maxPossibleCost, track_t& maxCost, cv::UMat currFrame);
-    void UpdateTrackingState(const regions_t& regions, cv::UMat currFrame, float fps);
+    SpatialGrid m_regionsGrid;
+    std::vector<int> m_allRegions;
+    std::vector<track_t> m_regionsX; // Regions centers for the ellipse gate kernel
+    std::vector<track_t> m_regionsY;
+    RectsSoA m_regionsRects;         // Regions bounding rectangles for the IoU kernel
+
+    ///
+    /// \brief The DistRow struct
+    /// Distances from one track, rows are calculated in parallel
+    ///
+    struct DistRow
+    {
+        std::vector<int> m_gateRegions;
+        std::vector<track_t> m_ellipseDists; // For the row regions
+        std::vector<float> m_iou;            // For the row regions
+        std::vector<int> m_cols;
+        std::vector<track_t> m_dists;
+        track_t m_maxCost = 0;
+    };
+    std::vector<DistRow> m_distRows;
+    SparseDistMatrix m_sparseDistMatrix;
+
+    ///
+    /// \brief The AssignmentBlock struct
+    /// Connected component of the tracks-regions graph
+    ///
+    struct AssignmentBlock
+    {
+        std::vector<int> m_tracks;
+        std::vector<int> m_regions;
+        distMatrix_t m_costMatrix;
+        assignments_t m_assignment;
+        std::unique_ptr<ShortPathCalculator> m_SPCalculator;
+    };
+    std::vector<AssignmentBlock> m_assignmentBlocks;
+    std::vector<int> m_componentsParent;
+    std::vector<int> m_componentsBlock;
+
+    std::unique_ptr<ShortPathCalculator> CreateSPCalculator() const;
+    void SolveByComponents(const distMatrix_t& costMatrix, size_t N, size_t M, assignments_t& assignment, track_t maxCost);
+
+    std::unique_ptr<EmbeddingsCalculator> m_embCalculator;
+
+    void CalcRegionEmbeddings(const regions_t& regions, cv::UMat currFrame, std::vector<RegionEmbedding>& regionEmbeddings);
+    void CreateDistaceMatrix(const regions_t& regions, const std::vector<RegionEmbedding>& regionEmbeddings, distMatrix_t& costMatrix, SparseDistMatrix& sparseMatrix, track_t maxPossibleCost, track_t& maxCost);
+    void UpdateTrackingState(const regions_t& regions, cv::UMat currFrame, float fps, track_t deltaTime);
 };
@@ -0,0 +1,59 @@
+#include "EllipseGate.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+///
+/// \brief EllipseGate::EllipseGate
+/// \param predictedArea - result of CTrack::CalcPredictionEllipse: half sizes are equal to the rrect size, angle in radians
+///
+EllipseGate::EllipseGate(const cv::RotatedRect& predictedArea)
+    : m_cx(predictedArea.center.x), m_cy(predictedArea.center.y)
+{
+    // Point is rotated by -angle: u = dx * cos + dy * sin, v = -dx * sin + dy * cos, d = u^2 / w^2 + v^2 / h^2
+    const track_t cosA = cosf(predictedArea.angle);
+    const track_t sinA = sinf(predictedArea.angle);
+    const track_t invW2 = 1.f / (predictedArea.size.width * predictedArea.size.width);
+    const track_t invH2 = 1.f / (predictedArea.size.height * predictedArea.size.height);
+    m_a = cosA * cosA * invW2 + sinA * sinA * invH2;
+    m_b2 = 2.f * cosA * sinA * (invW2 - invH2);
+    m_c = sinA * sinA * invW2 + cosA * cosA * invH2;
+}
+
+///
+/// \brief EllipseGate::Dists
+/// Distances for the points subset without branches: AVX2 with 8 points per iteration or scalar loop
+/// \param xs - points x coordinates
+/// \param ys - points y coordinates
+/// \param inds - indexes of the points in xs and ys
+/// \param count - size of inds and dists
+/// \param dists - result
+///
+void EllipseGate::Dists(const track_t* xs, const track_t* ys, const int* inds, size_t count, track_t* dists) const
+{
+    size_t i = 0;
+#ifdef __AVX2__
+    static_assert(sizeof(track_t) == sizeof(float), "AVX2 kernel is only for float coordinates");
+
+    const __m256 cx = _mm256_set1_ps(m_cx);
+    const __m256 cy = _mm256_set1_ps(m_cy);
+    const __m256 a = _mm256_set1_ps(m_a);
+    const __m256 b2 = _mm256_set1_ps(m_b2);
+    const __m256 c = _mm256_set1_ps(m_c);
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i ind = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inds + i));
+        const __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(xs, ind, 4), cx);
+        const __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(ys, ind, 4), cy);
+        // dx * (a * dx + b2 * dy) + c * dy * dy
+        const __m256 t = _mm256_add_ps(_mm256_mul_ps(a, dx), _mm256_mul_ps(b2, dy));
+        const __m256 d = _mm256_add_ps(_mm256_mul_ps(dx, t), _mm256_mul_ps(c, _mm256_mul_ps(dy, dy)));
+        _mm256_storeu_ps(dists + i, d);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        dists[i] = Dist(Point_t(xs[inds[i]], ys[inds[i]]));
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+
+#include "defines.h"
+
+///
+/// \brief The EllipseGate class
+/// Prediction ellipse of the track as the quadratic form: d = a * dx^2 + 2 * b * dx * dy + c * dy^2.
+/// It is calculated once per frame, d <= 1 if the point is inside the ellipse
+///
+class EllipseGate
+{
+public:
+    EllipseGate() = default;
+    EllipseGate(const cv::RotatedRect& predictedArea);
+
+    ///
+    /// \brief Dist
+    /// \param pt
+    /// \return
+    ///
+    track_t Dist(const Point_t& pt) const
+    {
+        const track_t dx = pt.x - m_cx;
+        const track_t dy = pt.y - m_cy;
+        return dx * (m_a * dx + m_b2 * dy) + m_c * dy * dy;
+    }
+
+    void Dists(const track_t* xs, const track_t* ys, const int* inds, size_t count, track_t* dists) const;
+
+private:
+    track_t m_cx = 0;
+    track_t m_cy = 0;
+    track_t m_a = 0;
+    track_t m_b2 = 0; // 2 * b
+    track_t m_c = 0;
+};
@@ -0,0 +1,103 @@
+#include "EmbeddingsCalculator.h"
+
+///
+/// \brief DNNEmbeddingsCalculator::Init
+/// \param config
+/// \return
+///
+bool DNNEmbeddingsCalculator::Init(const config_t& config)
+{
+    auto modelConfiguration = config.find("modelConfiguration");
+    auto modelBinary = config.find("modelBinary");
+    if (modelBinary == config.end())
+        return false;
+    m_net = cv::dnn::readNet(modelBinary->second, (modelConfiguration != config.end()) ? modelConfiguration->second : "", "");
+    if (m_net.empty())
+        return false;
+
+    m_net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    m_net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+
+    auto inWidth = config.find("inWidth");
+    if (inWidth != config.end())
+        m_inWidth = std::stoi(inWidth->second);
+    auto inHeight = config.find("inHeight");
+    if (inHeight != config.end())
+        m_inHeight = std::stoi(inHeight->second);
+    auto inScaleFactor = config.find("inScaleFactor");
+    if (inScaleFactor != config.end())
+        m_inScaleFactor = std::stof(inScaleFactor->second);
+    auto meanVal = config.find("meanVal");
+    if (meanVal != config.end())
+        m_meanVal = cv::Scalar::all(std::stof(meanVal->second));
+    auto swapRB = config.find("swapRB");
+    if (swapRB != config.end())
+        m_swapRB = std::stoi(swapRB->second) != 0;
+    auto maxBatch = config.find("maxBatch");
+    if (maxBatch != config.end())
+        m_maxBatch = std::max(1, std::stoi(maxBatch->second));
+
+    return true;
+}
+
+///
+/// \brief DNNEmbeddingsCalculator::Calc
+/// \param frame
+/// \param regions
+/// \param regionEmbeddings
+///
+void DNNEmbeddingsCalculator::Calc(cv::UMat frame, const regions_t& regions, std::vector<RegionEmbedding>& regionEmbeddings)
+{
+    const cv::Rect frameRect(0, 0, frame.cols, frame.rows);
+
+    m_crops.clear();
+    m_cropsRegions.clear();
+    for (size_t j = 0; j < regions.size(); ++j)
+    {
+        regionEmbeddings[j].m_embedding.release();
+
+        const cv::Rect roi = regions[j].m_brect & frameRect;
+        if (roi.empty())
+            continue;
+        m_crops.push_back(frame(roi));
+        m_cropsRegions.push_back(static_cast<int>(j));
+    }
+
+    // All crops in a few forward passes
+    for (size_t from = 0; from < m_crops.size(); from += m_maxBatch)
+    {
+        const size_t to = std::min(from + m_maxBatch, m_crops.size());
+        std::vector<cv::UMat> batch(m_crops.begin() + from, m_crops.begin() + to);
+        m_inputBlob = cv::dnn::blobFromImages(batch, m_inScaleFactor, cv::Size(m_inWidth, m_inHeight), m_meanVal, m_swapRB, false, CV_32F);
+        m_net.setInput(m_inputBlob);
+        cv::Mat features = m_net.forward();
+        if (features.empty())
+            continue;
+        features = features.reshape(1, static_cast<int>(to - from));
+
+        for (size_t i = from; i < to; ++i)
+        {
+            cv::Mat& embedding = regionEmbeddings[m_cropsRegions[i]].m_embedding;
+            features.row(static_cast<int>(i - from)).copyTo(embedding);
+            const double norm = cv::norm(embedding, cv::NORM_L2);
+            if (norm > 0)
+                embedding.convertTo(embedding, CV_32F, 1. / norm);
+        }
+    }
+}
+
+///
+/// \brief CreateEmbeddingsCalculator
+/// \param config
+/// \return Initialized calculator or nullptr
+///
+std::unique_ptr<EmbeddingsCalculator> CreateEmbeddingsCalculator(const config_t& config)
+{
+    std::unique_ptr<EmbeddingsCalculator> calculator = std::make_unique<DNNEmbeddingsCalculator>();
+    if (!calculator->Init(config))
+    {
+        std::cerr << "Appearance embeddings network was not initialized" << std::endl;
+        calculator.reset();
+    }
+    return calculator;
+}
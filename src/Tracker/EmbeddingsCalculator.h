@@ -0,0 +1,58 @@
+#pragma once
+
+#include <opencv2/dnn.hpp>
+
+#include "defines.h"
+#include "track.h"
+
+///
+/// \brief The EmbeddingsCalculator class
+/// Appearance embeddings (ReID features) extractor for tracking::DistFeatureCos
+///
+class EmbeddingsCalculator
+{
+public:
+    EmbeddingsCalculator() = default;
+    virtual ~EmbeddingsCalculator() = default;
+
+    virtual bool Init(const config_t& config) = 0;
+
+    ///
+    /// \brief Calc
+    /// Fill RegionEmbedding::m_embedding with L2 normalized features for all regions
+    /// \param frame
+    /// \param regions
+    /// \param regionEmbeddings - has regions.size() elements
+    ///
+    virtual void Calc(cv::UMat frame, const regions_t& regions, std::vector<RegionEmbedding>& regionEmbeddings) = 0;
+};
+
+///
+/// \brief The DNNEmbeddingsCalculator class
+/// OpenCV DNN network with batch of all regions crops
+///
+class DNNEmbeddingsCalculator : public EmbeddingsCalculator
+{
+public:
+    DNNEmbeddingsCalculator() = default;
+    ~DNNEmbeddingsCalculator() = default;
+
+    bool Init(const config_t& config);
+    void Calc(cv::UMat frame, const regions_t& regions, std::vector<RegionEmbedding>& regionEmbeddings);
+
+private:
+    cv::dnn::Net m_net;
+
+    int m_inWidth = 64;
+    int m_inHeight = 128;
+    float m_inScaleFactor = 1.f / 255.f;
+    cv::Scalar m_meanVal;
+    bool m_swapRB = true;
+    size_t m_maxBatch = 32;
+
+    std::vector<cv::UMat> m_crops;
+    std::vector<int> m_cropsRegions;
+    cv::Mat m_inputBlob;
+};
+
+std::unique_ptr<EmbeddingsCalculator> CreateEmbeddingsCalculator(const config_t& config);
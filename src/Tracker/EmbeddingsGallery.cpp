@@ -0,0 +1,75 @@
+#include "EmbeddingsGallery.h"
+
+namespace
+{
+///
+/// \brief DotProduct
+/// Independent accumulators give the compiler the vectorizable loop
+/// \param v1
+/// \param v2
+/// \param len
+/// \return
+///
+float DotProduct(const float* v1, const float* v2, size_t len)
+{
+    float acc[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        for (size_t k = 0; k < 8; ++k)
+        {
+            acc[k] += v1[i + k] * v2[i + k];
+        }
+    }
+    float res = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+    for (; i < len; ++i)
+    {
+        res += v1[i] * v2[i];
+    }
+    return res;
+}
+}
+
+///
+/// \brief EmbeddingsGallery::Add
+/// \param embedding - L2 normalized row, CV_32F
+///
+void EmbeddingsGallery::Add(const cv::Mat& embedding)
+{
+    if (embedding.empty())
+        return;
+
+    const size_t dim = embedding.total();
+    if (dim != m_dim)
+    {
+        // New network or the first embedding
+        m_dim = dim;
+        m_head = 0;
+        m_count = 0;
+        m_data.resize(m_capacity * m_dim);
+    }
+
+    const float* src = embedding.ptr<float>();
+    std::copy(src, src + m_dim, m_data.begin() + m_head * m_dim);
+    m_head = (m_head + 1) % m_capacity;
+    m_count = std::min(m_count + 1, m_capacity);
+}
+
+///
+/// \brief EmbeddingsGallery::CosineDist
+/// \param embedding - L2 normalized row, CV_32F
+/// \return Minimal cosine distance to the gallery from 0 to 1
+///
+track_t EmbeddingsGallery::CosineDist(const cv::Mat& embedding) const
+{
+    if (embedding.empty() || !m_count || embedding.total() != m_dim)
+        return 1;
+
+    const float* emb = embedding.ptr<float>();
+    float maxCos = -1;
+    for (size_t i = 0; i < m_count; ++i)
+    {
+        maxCos = std::max(maxCos, DotProduct(emb, &m_data[i * m_dim], m_dim));
+    }
+    return std::max(0.f, std::min(1.f, 1.f - maxCos));
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+
+#include "defines.h"
+
+///
+/// \brief The EmbeddingsGallery class
+/// Last appearance embeddings of the track in the fixed-size ring buffer
+///
+class EmbeddingsGallery
+{
+public:
+    EmbeddingsGallery(size_t capacity = 16)
+        : m_capacity(std::max<size_t>(capacity, 1))
+    {
+    }
+
+    void Add(const cv::Mat& embedding);
+    track_t CosineDist(const cv::Mat& embedding) const;
+
+    ///
+    /// \brief Empty
+    /// \return
+    ///
+    bool Empty() const
+    {
+        return m_count == 0;
+    }
+
+private:
+    size_t m_capacity = 16;
+    size_t m_dim = 0;
+    size_t m_head = 0;  // Place for the next embedding
+    size_t m_count = 0;
+    std::vector<float> m_data; // m_capacity x m_dim
+};
@@ -46,12 +46,12 @@ void AssignmentProblemSolver::assignmentoptimal(assignments_t& assignment, track
     m_distMatrix.assign(std::begin(distMatrixIn), std::end(distMatrixIn));
     const track_t* distMatrixEnd = m_distMatrix.data() + nOfElements;
 
-	// Memory allocation
-	bool* coveredColumns = (bool*)calloc(nOfColumns, sizeof(bool));
-	bool* coveredRows = (bool*)calloc(nOfRows, sizeof(bool));
-	bool* starMatrix = (bool*)calloc(nOfElements, sizeof(bool));
-	bool* primeMatrix = (bool*)calloc(nOfElements, sizeof(bool));
-	bool* newStarMatrix = (bool*)calloc(nOfElements, sizeof(bool)); /* used in step4 */
+	// Workspace initialization without new allocations for the known sizes
+	m_coveredColumns.Reset(nOfColumns);
+	m_coveredRows.Reset(nOfRows);
+	m_starMatrix.Reset(nOfElements);
+	m_primeMatrix.Reset(nOfElements);
+	m_newStarMatrix.Reset(nOfElements);
 
 	/* preliminary steps */
 	if (nOfRows <= nOfColumns)
@@ -85,10 +85,10 @@ void AssignmentProblemSolver::assignmentoptimal(assignments_t& assignment, track
 			{
                 if (m_distMatrix[row + nOfRows*col] == 0)
 				{
-					if (!coveredColumns[col])
+					if (!m_coveredColumns[col])
 					{
-						starMatrix[row + nOfRows * col] = true;
-						coveredColumns[col] = true;
+						m_starMatrix.Set(row + nOfRows * col);
+						m_coveredColumns.Set(col);
 						break;
 					}
 				}
@@ -123,44 +123,35 @@ void AssignmentProblemSolver::assignmentoptimal(assignments_t& assignment, track
 			{
                 if (m_distMatrix[row + nOfRows*col] == 0)
 				{
-					if (!coveredRows[row])
+					if (!m_coveredRows[row])
 					{
-						starMatrix[row + nOfRows*col] = true;
-						coveredColumns[col] = true;
-						coveredRows[row] = true;
+						m_starMatrix.Set(row + nOfRows*col);
+						m_coveredColumns.Set(col);
+						m_coveredRows.Set(row);
 						break;
 					}
 				}
 			}
 		}
 
-        for (size_t row = 0; row < nOfRows; ++row)
-		{
-			coveredRows[row] = false;
-		}
+		m_coveredRows.Clear();
 	}
 	/* move to step 2b */
-    step2b(assignment, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, (nOfRows <= nOfColumns) ? nOfRows : nOfColumns);
+    step2b(assignment, nOfRows, nOfColumns, (nOfRows <= nOfColumns) ? nOfRows : nOfColumns);
 	/* compute cost and remove invalid assignments */
 	computeassignmentcost(assignment, cost, distMatrixIn, nOfRows);
-	/* free allocated memory */
-	free(coveredColumns);
-	free(coveredRows);
-	free(starMatrix);
-	free(primeMatrix);
-	free(newStarMatrix);
 	return;
 }
 // --------------------------------------------------------------------------
 //
 // --------------------------------------------------------------------------
-void AssignmentProblemSolver::buildassignmentvector(assignments_t& assignment, bool *starMatrix, size_t nOfRows, size_t nOfColumns)
+void AssignmentProblemSolver::buildassignmentvector(assignments_t& assignment, size_t nOfRows, size_t nOfColumns)
 {
     for (size_t row = 0; row < nOfRows; ++row)
 	{
         for (size_t col = 0; col < nOfColumns; ++col)
 		{
-			if (starMatrix[row + nOfRows * col])
+			if (m_starMatrix[row + nOfRows * col])
 			{
 				assignment[row] = static_cast<int>(col);
 				break;
@@ -184,49 +175,48 @@ void AssignmentProblemSolver::computeassignmentcost(const assignments_t& assignm
 // --------------------------------------------------------------------------
 //
 // --------------------------------------------------------------------------
-void AssignmentProblemSolver::step2a(assignments_t& assignment, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, size_t nOfRows, size_t nOfColumns, size_t minDim)
+void AssignmentProblemSolver::step2a(assignments_t& assignment, size_t nOfRows, size_t nOfColumns, size_t minDim)
 {
-    bool *starMatrixTemp, *columnEnd;
     /* cover every column containing a starred zero */
     for (size_t col = 0; col < nOfColumns; ++col)
     {
-        starMatrixTemp = starMatrix + nOfRows * col;
-        columnEnd = starMatrixTemp + nOfRows;
-        while (starMatrixTemp < columnEnd)
+        const size_t columnBegin = nOfRows * col;
+        const size_t columnEnd = columnBegin + nOfRows;
+        for (size_t n = columnBegin; n < columnEnd; ++n)
         {
-            if (*starMatrixTemp++)
+            if (m_starMatrix[n])
             {
-                coveredColumns[col] = true;
+                m_coveredColumns.Set(col);
                 break;
             }
         }
     }
     /* move to step 3 */
-    step2b(assignment, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, minDim);
+    step2b(assignment, nOfRows, nOfColumns, minDim);
 }
 
 // --------------------------------------------------------------------------
 //
 // --------------------------------------------------------------------------
-void AssignmentProblemSolver::step2b(assignments_t& assignment, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, size_t nOfRows, size_t nOfColumns, size_t minDim)
+void AssignmentProblemSolver::step2b(assignments_t& assignment, size_t nOfRows, size_t nOfColumns, size_t minDim)
 {
 	/* count covered columns */
     size_t nOfCoveredColumns = 0;
     for (size_t col = 0; col < nOfColumns; ++col)
 	{
-		if (coveredColumns[col])
+		if (m_coveredColumns[col])
 			nOfCoveredColumns++;
 	}
     if (nOfCoveredColumns == minDim) // algorithm finished
-		buildassignmentvector(assignment, starMatrix, nOfRows, nOfColumns);
+		buildassignmentvector(assignment, nOfRows, nOfColumns);
     else                             // move to step 3
-        step3_5(assignment, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, minDim);
+        step3_5(assignment, nOfRows, nOfColumns, minDim);
 }
 
 // --------------------------------------------------------------------------
 //
 // --------------------------------------------------------------------------
-void AssignmentProblemSolver::step3_5(assignments_t& assignment, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, size_t nOfRows, size_t nOfColumns, size_t minDim)
+void AssignmentProblemSolver::step3_5(assignments_t& assignment, size_t nOfRows, size_t nOfColumns, size_t minDim)
 {
 	for (;;)
 	{
@@ -237,31 +227,31 @@ void AssignmentProblemSolver::step3_5(assignments_t& assignment, bool *starMatri
 			zerosFound = false;
             for (size_t col = 0; col < nOfColumns; ++col)
 			{
-				if (!coveredColumns[col])
+				if (!m_coveredColumns[col])
 				{
                     for (size_t row = 0; row < nOfRows; ++row)
 					{
-                        if ((!coveredRows[row]) && (m_distMatrix[row + nOfRows*col] == 0))
+                        if ((!m_coveredRows[row]) && (m_distMatrix[row + nOfRows*col] == 0))
 						{
 							/* prime zero */
-							primeMatrix[row + nOfRows*col] = true;
+							m_primeMatrix.Set(row + nOfRows*col);
 							/* find starred zero in current row */
 							size_t starCol = 0;
                             for (; starCol < nOfColumns; ++starCol)
 							{
-								if (starMatrix[row + nOfRows * starCol])
+								if (m_starMatrix[row + nOfRows * starCol])
 									break;
 							}
 							if (starCol == nOfColumns) /* no starred zero found */
 							{
 								/* move to step 4 */
-                                step4(assignment, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, minDim, row, col);
+                                step4(assignment, nOfRows, nOfColumns, minDim, row, col);
 								return;
 							}
 							else
 							{
-								coveredRows[row] = true;
-								coveredColumns[starCol] = false;
+								m_coveredRows.Set(row);
+								m_coveredColumns.Unset(starCol);
 								zerosFound = true;
 								break;
 							}
@@ -274,11 +264,11 @@ void AssignmentProblemSolver::step3_5(assignments_t& assignment, bool *starMatri
         track_t h = std::numeric_limits<track_t>::max();
         for (size_t row = 0; row < nOfRows; ++row)
 		{
-			if (!coveredRows[row])
+			if (!m_coveredRows[row])
 			{
                 for (size_t col = 0; col < nOfColumns; ++col)
 				{
-					if (!coveredColumns[col])
+					if (!m_coveredColumns[col])
 					{
                         const track_t value = m_distMatrix[row + nOfRows*col];
 						if (value < h)
@@ -290,7 +280,7 @@ void AssignmentProblemSolver::step3_5(assignments_t& assignment, bool *starMatri
 		/* add h to each covered row */
         for (size_t row = 0; row < nOfRows; ++row)
 		{
-			if (coveredRows[row])
+			if (m_coveredRows[row])
 			{
                 for (size_t col = 0; col < nOfColumns; ++col)
 				{
@@ -301,7 +291,7 @@ void AssignmentProblemSolver::step3_5(assignments_t& assignment, bool *starMatri
 		/* subtract h from each uncovered column */
         for (size_t col = 0; col < nOfColumns; ++col)
 		{
-			if (!coveredColumns[col])
+			if (!m_coveredColumns[col])
 			{
                 for (size_t row = 0; row < nOfRows; ++row)
 				{
@@ -315,59 +305,49 @@ void AssignmentProblemSolver::step3_5(assignments_t& assignment, bool *starMatri
 // --------------------------------------------------------------------------
 //
 // --------------------------------------------------------------------------
-void AssignmentProblemSolver::step4(assignments_t& assignment, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, size_t nOfRows, size_t nOfColumns, size_t minDim, size_t row, size_t col)
+void AssignmentProblemSolver::step4(assignments_t& assignment, size_t nOfRows, size_t nOfColumns, size_t minDim, size_t row, size_t col)
 {
-	const size_t nOfElements = nOfRows * nOfColumns;
 	/* generate temporary copy of starMatrix */
-    for (size_t n = 0; n < nOfElements; ++n)
-	{
-		newStarMatrix[n] = starMatrix[n];
-	}
+	m_newStarMatrix.CopyFrom(m_starMatrix);
 	/* star current zero */
-	newStarMatrix[row + nOfRows*col] = true;
+	m_newStarMatrix.Set(row + nOfRows*col);
 	/* find starred zero in current column */
 	size_t starCol = col;
 	size_t starRow = 0;
     for (; starRow < nOfRows; ++starRow)
 	{
-		if (starMatrix[starRow + nOfRows * starCol])
+		if (m_starMatrix[starRow + nOfRows * starCol])
 			break;
 	}
 	while (starRow < nOfRows)
 	{
 		/* unstar the starred zero */
-		newStarMatrix[starRow + nOfRows*starCol] = false;
+		m_newStarMatrix.Unset(starRow + nOfRows*starCol);
 		/* find primed zero in current row */
 		size_t primeRow = starRow;
 		size_t primeCol = 0;
         for (; primeCol < nOfColumns; ++primeCol)
 		{
-			if (primeMatrix[primeRow + nOfRows * primeCol])
+			if (m_primeMatrix[primeRow + nOfRows * primeCol])
 				break;
 		}
 		/* star the primed zero */
-		newStarMatrix[primeRow + nOfRows*primeCol] = true;
+		m_newStarMatrix.Set(primeRow + nOfRows*primeCol);
 		/* find starred zero in current column */
 		starCol = primeCol;
         for (starRow = 0; starRow < nOfRows; ++starRow)
 		{
-			if (starMatrix[starRow + nOfRows * starCol])
+			if (m_starMatrix[starRow + nOfRows * starCol])
 				break;
 		}
 	}
 	/* use temporary copy as new starMatrix */
+	m_starMatrix.Swap(m_newStarMatrix);
 	/* delete all primes, uncover all rows */
-    for (size_t n = 0; n < nOfElements; ++n)
-	{
-		primeMatrix[n] = false;
-		starMatrix[n] = newStarMatrix[n];
-	}
-    for (size_t n = 0; n < nOfRows; ++n)
-	{
-		coveredRows[n] = false;
-	}
+	m_primeMatrix.Clear();
+	m_coveredRows.Clear();
 	/* move to step 2a */
-    step2a(assignment, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, minDim);
+    step2a(assignment, nOfRows, nOfColumns, minDim);
 }
 
 // --------------------------------------------------------------------------
@@ -426,9 +406,11 @@ void AssignmentProblemSolver::assignmentsuboptimal1(assignments_t& assignment, t
 	/* make working copy of distance Matrix */
     m_distMatrix.assign(std::begin(distMatrixIn), std::end(distMatrixIn));
 
-	/* allocate memory */
-	int* nOfValidObservations = (int *)calloc(nOfRows, sizeof(int));
-	int* nOfValidTracks = (int *)calloc(nOfColumns, sizeof(int));
+	/* reset workspace */
+	m_nOfValidObservations.assign(nOfRows, 0);
+	m_nOfValidTracks.assign(nOfColumns, 0);
+	int* nOfValidObservations = m_nOfValidObservations.data();
+	int* nOfValidTracks = m_nOfValidTracks.data();
 
 	/* compute number of validations */
 	bool infiniteValueFound = false;
@@ -453,12 +435,7 @@ void AssignmentProblemSolver::assignmentsuboptimal1(assignments_t& assignment, t
 	if (infiniteValueFound)
 	{
 		if (!finiteValueFound)
-		{
-            /* free allocated memory */
-            free(nOfValidObservations);
-            free(nOfValidTracks);
 			return;
-		}
 		bool repeatSteps = true;
 
 		while (repeatSteps)
@@ -648,8 +625,4 @@ void AssignmentProblemSolver::assignmentsuboptimal1(assignments_t& assignment, t
 			break;
 		}
 	}
-
-	/* free allocated memory */
-	free(nOfValidObservations);
-	free(nOfValidTracks);
 }
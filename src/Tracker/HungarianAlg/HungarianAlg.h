@@ -1,10 +1,74 @@
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <limits>
 #include <time.h>
+#include <cstdint>
 #include "defines.h"
 // http://community.topcoder.com/tc?module=Static&d1=tutorials&d2=hungarianAlgorithm
 
+///
+/// \brief The BitVector class
+/// Bit-packed flags, memory is kept between Reset calls
+///
+class BitVector
+{
+public:
+    ///
+    /// \brief Reset
+    /// Resize and set all flags to false
+    /// \param size
+    ///
+    void Reset(size_t size)
+    {
+        m_words.assign((size + WORD_BITS - 1) / WORD_BITS, 0);
+    }
+
+    ///
+    /// \brief Clear
+    /// Set all flags to false
+    ///
+    void Clear()
+    {
+        std::fill(m_words.begin(), m_words.end(), 0);
+    }
+
+    bool operator[](size_t i) const
+    {
+        return (m_words[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+    }
+
+    void Set(size_t i)
+    {
+        m_words[i / WORD_BITS] |= (word_t(1) << (i % WORD_BITS));
+    }
+
+    void Unset(size_t i)
+    {
+        m_words[i / WORD_BITS] &= ~(word_t(1) << (i % WORD_BITS));
+    }
+
+    void Swap(BitVector& other)
+    {
+        m_words.swap(other.m_words);
+    }
+
+    ///
+    /// \brief CopyFrom
+    /// \param other - must have the same size
+    ///
+    void CopyFrom(const BitVector& other)
+    {
+        std::copy(other.m_words.begin(), other.m_words.end(), m_words.begin());
+    }
+
+private:
+    typedef uint64_t word_t;
+    static constexpr size_t WORD_BITS = 64;
+
+    std::vector<word_t> m_words;
+};
+
 ///
 /// \brief The AssignmentProblemSolver class
 ///
@@ -25,17 +89,25 @@ public:
 private:
 	// Computes the optimal assignment (minimum overall costs) using Munkres algorithm.
 	void assignmentoptimal(assignments_t& assignment, track_t& cost, const distMatrix_t& distMatrixIn, size_t nOfRows, size_t nOfColumns);
-	void buildassignmentvector(assignments_t& assignment, bool *starMatrix, size_t nOfRows, size_t nOfColumns);
+	void buildassignmentvector(assignments_t& assignment, size_t nOfRows, size_t nOfColumns);
 	void computeassignmentcost(const assignments_t& assignment, track_t& cost, const distMatrix_t& distMatrixIn, size_t nOfRows);
-    void step2a(assignments_t& assignment, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, size_t nOfRows, size_t nOfColumns, size_t minDim);
-    void step2b(assignments_t& assignment, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, size_t nOfRows, size_t nOfColumns, size_t minDim);
-    void step3_5(assignments_t& assignment, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, size_t nOfRows, size_t nOfColumns, size_t minDim);
-    void step4(assignments_t& assignment, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, size_t nOfRows, size_t nOfColumns, size_t minDim, size_t row, size_t col);
+    void step2a(assignments_t& assignment, size_t nOfRows, size_t nOfColumns, size_t minDim);
+    void step2b(assignments_t& assignment, size_t nOfRows, size_t nOfColumns, size_t minDim);
+    void step3_5(assignments_t& assignment, size_t nOfRows, size_t nOfColumns, size_t minDim);
+    void step4(assignments_t& assignment, size_t nOfRows, size_t nOfColumns, size_t minDim, size_t row, size_t col);
 
 	// Computes a suboptimal solution. Good for cases with many forbidden assignments.
 	void assignmentsuboptimal1(assignments_t& assignment, track_t& cost, const distMatrix_t& distMatrixIn, size_t nOfRows, size_t nOfColumns);
 	// Computes a suboptimal solution. Good for cases with many forbidden assignments.
 	void assignmentsuboptimal2(assignments_t& assignment, track_t& cost, const distMatrix_t& distMatrixIn, size_t nOfRows, size_t nOfColumns);
 
+    // Workspace, grows to the maximal matrix size and is reused between Solve calls
     std::vector<track_t> m_distMatrix;
+    BitVector m_coveredColumns;
+    BitVector m_coveredRows;
+    BitVector m_starMatrix;
+    BitVector m_primeMatrix;
+    BitVector m_newStarMatrix; // used in step4
+    std::vector<int> m_nOfValidObservations;
+    std::vector<int> m_nOfValidTracks;
 };
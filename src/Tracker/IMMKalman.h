@@ -0,0 +1,213 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include "LinearKalman.h"
+
+///
+/// \brief The TIMMKalman class
+/// Interacting Multiple Model filter with the constant velocity and constant acceleration linear filters.
+/// Both filters work in the state (measured values, velocities, accelerations), the constant velocity model resets acceleration to zero.
+/// So the mixing uses only fixed size cv::Matx and the cost per track is two linear filters
+///
+template<int MEAS>
+class TIMMKalman
+{
+public:
+    static constexpr int STATE = 3 * MEAS;
+    static constexpr int CV_STATE = 2 * MEAS;
+    static constexpr int MODELS = 2;
+
+    typedef TLinearKalman<STATE, MEAS> filter_t;
+    typedef typename filter_t::state_t state_t;
+    typedef typename filter_t::meas_t meas_t;
+    typedef typename filter_t::cov_t cov_t;
+
+    ///
+    /// \brief Init
+    /// \param cvTransition - CV_STATE x CV_STATE values of the constant velocity model
+    /// \param cvProcessNoise - CV_STATE x CV_STATE values of the constant velocity model
+    /// \param caTransition - STATE x STATE values of the constant acceleration model
+    /// \param caProcessNoise - STATE x STATE values of the constant acceleration model
+    /// \param state0 - STATE values
+    /// \param measurementNoise
+    /// \param errorCov
+    /// \param switchProb - probability of the model change between two frames
+    ///
+    void Init(const track_t* cvTransition, const track_t* cvProcessNoise, const track_t* caTransition, const track_t* caProcessNoise,
+              const track_t* state0, track_t measurementNoise, track_t errorCov, track_t switchProb = 0.05f)
+    {
+        for (auto& filter : m_filters)
+        {
+            filter.Init(caTransition, caProcessNoise, state0, measurementNoise, errorCov);
+        }
+        SetModel(cvTransition, cvProcessNoise, caTransition, caProcessNoise);
+
+        for (int i = 0; i < MODELS; ++i)
+        {
+            m_modelProb[i] = static_cast<track_t>(1) / MODELS;
+            for (int j = 0; j < MODELS; ++j)
+            {
+                m_switchProb[i][j] = (i == j) ? (1 - switchProb) : (switchProb / (MODELS - 1));
+            }
+        }
+        m_state = state_t(state0);
+    }
+
+    ///
+    /// \brief SetModel
+    /// Change the motion models and keep the current states and covariances
+    ///
+    void SetModel(const track_t* cvTransition, const track_t* cvProcessNoise, const track_t* caTransition, const track_t* caProcessNoise)
+    {
+        // Constant velocity model in the acceleration state: zero rows for accelerations and their noise from the acceleration model
+        cov_t transition = cov_t::zeros();
+        cov_t processNoise = cov_t::zeros();
+        for (int i = 0; i < CV_STATE; ++i)
+        {
+            for (int j = 0; j < CV_STATE; ++j)
+            {
+                transition(i, j) = cvTransition[i * CV_STATE + j];
+                processNoise(i, j) = cvProcessNoise[i * CV_STATE + j];
+            }
+        }
+        for (int i = CV_STATE; i < STATE; ++i)
+        {
+            processNoise(i, i) = caProcessNoise[i * STATE + i];
+        }
+        m_filters[ConstVelocity].SetModel(transition.val, processNoise.val);
+        m_filters[ConstAcceleration].SetModel(caTransition, caProcessNoise);
+    }
+
+    ///
+    /// \brief Predict
+    /// Mix the models estimations and predict every model
+    /// \return Combined prediction
+    ///
+    const state_t& Predict()
+    {
+        track_t predictedProb[MODELS];
+        state_t mixedStates[MODELS];
+        cov_t mixedCovs[MODELS];
+        for (int j = 0; j < MODELS; ++j)
+        {
+            predictedProb[j] = 0;
+            for (int i = 0; i < MODELS; ++i)
+            {
+                predictedProb[j] += m_switchProb[i][j] * m_modelProb[i];
+            }
+
+            track_t mixWeights[MODELS];
+            mixedStates[j] = state_t::zeros();
+            for (int i = 0; i < MODELS; ++i)
+            {
+                mixWeights[i] = m_switchProb[i][j] * m_modelProb[i] / predictedProb[j];
+                mixedStates[j] += mixWeights[i] * m_filters[i].m_statePost;
+            }
+            mixedCovs[j] = cov_t::zeros();
+            for (int i = 0; i < MODELS; ++i)
+            {
+                const state_t dx = m_filters[i].m_statePost - mixedStates[j];
+                mixedCovs[j] += mixWeights[i] * (m_filters[i].ErrorCovPost() + dx * dx.t());
+            }
+        }
+
+        m_state = state_t::zeros();
+        for (int j = 0; j < MODELS; ++j)
+        {
+            m_filters[j].SetStatePost(mixedStates[j], mixedCovs[j]);
+            m_state += predictedProb[j] * m_filters[j].Predict();
+            m_modelProb[j] = predictedProb[j];
+        }
+        return m_state;
+    }
+
+    ///
+    /// \brief Correct
+    /// Correct every model and update the models probabilities from the measurement likelihoods
+    /// \param measurement
+    /// \return Combined estimation
+    ///
+    const state_t& Correct(const meas_t& measurement)
+    {
+        track_t logLikelihood[MODELS];
+        track_t maxLogLikelihood = -std::numeric_limits<track_t>::max();
+        for (int j = 0; j < MODELS; ++j)
+        {
+            m_filters[j].Correct(measurement);
+            logLikelihood[j] = m_filters[j].LogLikelihood();
+            maxLogLikelihood = std::max(maxLogLikelihood, logLikelihood[j]);
+        }
+
+        // Likelihoods relative to the maximum: no underflow for the far measurements.
+        // The probabilities are bounded from zero so the model can be switched back
+        constexpr track_t minProb = 1e-3f;
+        track_t probSum = 0;
+        for (int j = 0; j < MODELS; ++j)
+        {
+            m_modelProb[j] = std::max(minProb, m_modelProb[j] * std::exp(logLikelihood[j] - maxLogLikelihood));
+            probSum += m_modelProb[j];
+        }
+        m_state = state_t::zeros();
+        for (int j = 0; j < MODELS; ++j)
+        {
+            m_modelProb[j] /= probSum;
+            m_state += m_modelProb[j] * m_filters[j].m_statePost;
+        }
+        return m_state;
+    }
+
+    ///
+    /// \brief GetVelocity
+    /// \return Combined velocity of the first two measured values
+    ///
+    cv::Vec<track_t, 2> GetVelocity() const
+    {
+        return cv::Vec<track_t, 2>(m_state(MEAS), m_state(MEAS + 1));
+    }
+
+    ///
+    /// \brief PositionCov
+    /// Mixed covariance of the first two measured values: the models covariances and the spread of the models estimations,
+    /// so it grows when the models disagree, for example, at the start of a manoeuvre
+    /// \return
+    ///
+    cv::Matx<track_t, 2, 2> PositionCov() const
+    {
+        cv::Matx<track_t, 2, 2> cov = cv::Matx<track_t, 2, 2>::zeros();
+        for (int j = 0; j < MODELS; ++j)
+        {
+            const cv::Matx<track_t, 2, 2> modelCov = m_filters[j].PositionCov();
+            const track_t d[] = { m_filters[j].m_statePost(0) - m_state(0), m_filters[j].m_statePost(1) - m_state(1) };
+            for (int r = 0; r < 2; ++r)
+            {
+                for (int c = 0; c < 2; ++c)
+                {
+                    cov(r, c) += m_modelProb[j] * (modelCov(r, c) + d[r] * d[c]);
+                }
+            }
+        }
+        return cov;
+    }
+
+    ///
+    /// \brief ModelProbability
+    /// \param model - 0 for the constant velocity, 1 for the constant acceleration
+    /// \return
+    ///
+    track_t ModelProbability(int model) const
+    {
+        return m_modelProb[model];
+    }
+
+private:
+    enum Models
+    {
+        ConstVelocity = 0,
+        ConstAcceleration = 1
+    };
+
+    filter_t m_filters[MODELS];
+    track_t m_modelProb[MODELS];
+    track_t m_switchProb[MODELS][MODELS]; // Markov chain of the models: m_switchProb[from][to]
+    state_t m_state;
+};
@@ -1,27 +1,12 @@
 #include "Kalman.h"
-#include <iostream>
 #include <vector>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
 
 //---------------------------------------------------------------------------
-TKalmanFilter::TKalmanFilter(
-        tracking::KalmanType type,
-	    bool useAcceleration,
-        track_t deltaTime, // time increment (lower values makes target more "massive")
-        track_t accelNoiseMag
-        )
-    :
-      m_accelNoiseMag(accelNoiseMag),
-      m_deltaTime(deltaTime),
-      m_deltaTimeMin(deltaTime),
-      m_deltaTimeMax(2 * deltaTime),
-      m_type(type),
-      m_useAcceleration(useAcceleration)
-{
-    m_deltaStep = (m_deltaTimeMax - m_deltaTimeMin) / m_deltaStepsCount;
-}
-
-//---------------------------------------------------------------------------
-void TKalmanFilter::CreateLinear(Point_t xy0, Point_t xyv0)
+template<>
+void TKalmanFilterT<tracking::ConstantVelocity, tracking::PointMeasurement>::MakeModel(track_t deltaTime, track_t accelNoiseMag, track_t* transitionOut, track_t* processNoiseOut)
 {
     // We don't know acceleration, so, assume it to process noise.
     // But we can guess, the range of acceleration values thich can be achieved by tracked object.
@@ -29,179 +14,115 @@ void TKalmanFilter::CreateLinear(Point_t xy0, Point_t xyv0)
     // shows, woh much target can accelerate.
 
     // 4 state variables, 2 measurements
-    m_linearKalman.init(4, 2, 0, El_t);
     // Transition cv::Matrix
-    m_linearKalman.transitionMatrix = (cv::Mat_<track_t>(4, 4) <<
-                                        1, 0, m_deltaTime, 0,
-                                        0, 1, 0, m_deltaTime,
-                                        0, 0, 1, 0,
-                                        0, 0, 0, 1);
-
-    // init...
-    m_lastPointResult = xy0;
-    m_linearKalman.statePre.at<track_t>(0) = xy0.x;  // x
-    m_linearKalman.statePre.at<track_t>(1) = xy0.y;  // y
-    m_linearKalman.statePre.at<track_t>(2) = xyv0.x; // vx
-    m_linearKalman.statePre.at<track_t>(3) = xyv0.y; // vy
-
-    m_linearKalman.statePost.at<track_t>(0) = xy0.x;
-    m_linearKalman.statePost.at<track_t>(1) = xy0.y;
-    m_linearKalman.statePost.at<track_t>(2) = xyv0.x;
-    m_linearKalman.statePost.at<track_t>(3) = xyv0.y;
-
-    cv::setIdentity(m_linearKalman.measurementMatrix);
-
-    m_linearKalman.processNoiseCov = (cv::Mat_<track_t>(4, 4) <<
-                                       pow(m_deltaTime,4.0)/4.0	,0						,pow(m_deltaTime,3.0)/2.0		,0,
-                                       0						,pow(m_deltaTime,4.0)/4.0	,0							,pow(m_deltaTime,3.0)/2.0,
-                                       pow(m_deltaTime,3.0)/2.0	,0						,pow(m_deltaTime,2.0)			,0,
-                                       0						,pow(m_deltaTime,3.0)/2.0	,0							,pow(m_deltaTime,2.0));
-
-
-    m_linearKalman.processNoiseCov *= m_accelNoiseMag;
-
-    cv::setIdentity(m_linearKalman.measurementNoiseCov, cv::Scalar::all(0.1));
-
-    cv::setIdentity(m_linearKalman.errorCovPost, cv::Scalar::all(.1));
-
-	m_initialPoints.reserve(MIN_INIT_VALS);
-
-    m_initialized = true;
+    const track_t dt = deltaTime;
+    const track_t transition[] = {
+        1, 0, dt, 0,
+        0, 1, 0,  dt,
+        0, 0, 1,  0,
+        0, 0, 0,  1 };
+
+
+    const track_t n1 = accelNoiseMag * pow(deltaTime, 4.f) / 4.f;
+    const track_t n2 = accelNoiseMag * pow(deltaTime, 3.f) / 2.f;
+    const track_t n3 = accelNoiseMag * pow(deltaTime, 2.f);
+    const track_t processNoise[] = {
+        n1, 0,  n2, 0,
+        0,  n1, 0,  n2,
+        n2, 0,  n3, 0,
+        0,  n2, 0,  n3 };
+
+    std::copy(std::begin(transition), std::end(transition), transitionOut);
+    std::copy(std::begin(processNoise), std::end(processNoise), processNoiseOut);
 }
 
 //---------------------------------------------------------------------------
-void TKalmanFilter::CreateLinear(cv::Rect_<track_t> rect0, Point_t rectv0)
+template<>
+void TKalmanFilterT<tracking::ConstantVelocity, tracking::RectMeasurement>::MakeModel(track_t deltaTime, track_t accelNoiseMag, track_t* transitionOut, track_t* processNoiseOut)
 {
     // We don't know acceleration, so, assume it to process noise.
     // But we can guess, the range of acceleration values thich can be achieved by tracked object.
     // Process noise. (standard deviation of acceleration: m/s^2)
     // shows, woh much target can accelerate.
 
-    // 8 state variables (x, y, vx, vy, width, height, vw, vh), 4 measurements (x, y, width, height)
-    m_linearKalman.init(8, 4, 0, El_t);
+    // 8 state variables (x, y, width, height, vx, vy, vw, vh), 4 measurements (x, y, width, height)
     // Transition cv::Matrix
-    m_linearKalman.transitionMatrix = (cv::Mat_<track_t>(8, 8) <<
-                                        1, 0, 0, 0, m_deltaTime, 0,           0,           0,
-                                        0, 1, 0, 0, 0,           m_deltaTime, 0,           0,
-                                        0, 0, 1, 0, 0,           0,           m_deltaTime, 0,
-                                        0, 0, 0, 1, 0,           0,           0,           m_deltaTime,
-                                        0, 0, 0, 0, 1,           0,           0,           0,
-                                        0, 0, 0, 0, 0,           1,           0,           0,
-                                        0, 0, 0, 0, 0,           0,           1,           0,
-                                        0, 0, 0, 0, 0,           0,           0,           1);
-
-    // init...
-    m_linearKalman.statePre.at<track_t>(0) = rect0.x;      // x
-    m_linearKalman.statePre.at<track_t>(1) = rect0.y;      // y
-    m_linearKalman.statePre.at<track_t>(2) = rect0.width;  // width
-    m_linearKalman.statePre.at<track_t>(3) = rect0.height; // height
-    m_linearKalman.statePre.at<track_t>(4) = rectv0.x;     // dx
-    m_linearKalman.statePre.at<track_t>(5) = rectv0.y;     // dy
-    m_linearKalman.statePre.at<track_t>(6) = 0;            // dw
-    m_linearKalman.statePre.at<track_t>(7) = 0;            // dh
-
-    m_linearKalman.statePost.at<track_t>(0) = rect0.x;
-    m_linearKalman.statePost.at<track_t>(1) = rect0.y;
-    m_linearKalman.statePost.at<track_t>(2) = rect0.width;
-    m_linearKalman.statePost.at<track_t>(3) = rect0.height;
-    m_linearKalman.statePost.at<track_t>(4) = rectv0.x;
-    m_linearKalman.statePost.at<track_t>(5) = rectv0.y;
-    m_linearKalman.statePost.at<track_t>(6) = 0;
-    m_linearKalman.statePost.at<track_t>(7) = 0;
-
-    cv::setIdentity(m_linearKalman.measurementMatrix);
-
-    track_t n1 = pow(m_deltaTime, 4.f) / 4.f;
-    track_t n2 = pow(m_deltaTime, 3.f) / 2.f;
-    track_t n3 = pow(m_deltaTime, 2.f);
-    m_linearKalman.processNoiseCov = (cv::Mat_<track_t>(8, 8) <<
-                                       n1, 0,  0,  0,  n2, 0,  0,  0,
-                                       0,  n1, 0,  0,  0,  n2, 0,  0,
-                                       0,  0,  n1, 0,  0,  0,  n2, 0,
-                                       0,  0,  0,  n1, 0,  0,  0,  n2,
-                                       n2, 0,  0,  0,  n3, 0,  0,  0,
-                                       0,  n2, 0,  0,  0,  n3, 0,  0,
-                                       0,  0,  n2, 0,  0,  0,  n3, 0,
-                                       0,  0,  0,  n2, 0,  0,  0,  n3);
-
-    m_linearKalman.processNoiseCov *= m_accelNoiseMag;
-
-    cv::setIdentity(m_linearKalman.measurementNoiseCov, cv::Scalar::all(0.1));
-
-    cv::setIdentity(m_linearKalman.errorCovPost, cv::Scalar::all(.1));
-
-	m_initialRects.reserve(MIN_INIT_VALS);
-
-    m_initialized = true;
+    const track_t dt = deltaTime;
+    const track_t transition[] = {
+        1, 0, 0, 0, dt, 0,  0,  0,
+        0, 1, 0, 0, 0,  dt, 0,  0,
+        0, 0, 1, 0, 0,  0,  dt, 0,
+        0, 0, 0, 1, 0,  0,  0,  dt,
+        0, 0, 0, 0, 1,  0,  0,  0,
+        0, 0, 0, 0, 0,  1,  0,  0,
+        0, 0, 0, 0, 0,  0,  1,  0,
+        0, 0, 0, 0, 0,  0,  0,  1 };
+
+
+    const track_t n1 = accelNoiseMag * pow(deltaTime, 4.f) / 4.f;
+    const track_t n2 = accelNoiseMag * pow(deltaTime, 3.f) / 2.f;
+    const track_t n3 = accelNoiseMag * pow(deltaTime, 2.f);
+    const track_t processNoise[] = {
+        n1, 0,  0,  0,  n2, 0,  0,  0,
+        0,  n1, 0,  0,  0,  n2, 0,  0,
+        0,  0,  n1, 0,  0,  0,  n2, 0,
+        0,  0,  0,  n1, 0,  0,  0,  n2,
+        n2, 0,  0,  0,  n3, 0,  0,  0,
+        0,  n2, 0,  0,  0,  n3, 0,  0,
+        0,  0,  n2, 0,  0,  0,  n3, 0,
+        0,  0,  0,  n2, 0,  0,  0,  n3 };
+
+    std::copy(std::begin(transition), std::end(transition), transitionOut);
+    std::copy(std::begin(processNoise), std::end(processNoise), processNoiseOut);
 }
 
 //---------------------------------------------------------------------------
-void TKalmanFilter::CreateLinearAcceleration(Point_t xy0, Point_t xyv0)
+template<>
+void TKalmanFilterT<tracking::ConstantAcceleration, tracking::PointMeasurement>::MakeModel(track_t deltaTime, track_t accelNoiseMag, track_t* transitionOut, track_t* processNoiseOut)
 {
 	// 6 state variables, 2 measurements
-	m_linearKalman.init(6, 2, 0, El_t);
 	// Transition cv::Matrix
-	const track_t dt = m_deltaTime;
-	const track_t dt2 = 0.5f * m_deltaTime * m_deltaTime;
-	m_linearKalman.transitionMatrix = (cv::Mat_<track_t>(6, 6) <<
+	const track_t dt = deltaTime;
+	const track_t dt2 = 0.5f * deltaTime * deltaTime;
+	const track_t transition[] = {
 		1, 0, dt, 0,  dt2, 0,
 		0, 1, 0,  dt, 0,   dt2,
 		0, 0, 1,  0,  dt,  0,
 		0, 0, 0,  1,  0,   dt,
 	    0, 0, 0,  0,  1,   0,
-	    0, 0, 0,  0,  0,   1);
-
-	// init...
-	m_lastPointResult = xy0;
-	m_linearKalman.statePre.at<track_t>(0) = xy0.x;  // x
-	m_linearKalman.statePre.at<track_t>(1) = xy0.y;  // y
-	m_linearKalman.statePre.at<track_t>(2) = xyv0.x; // vx
-	m_linearKalman.statePre.at<track_t>(3) = xyv0.y; // vy
-	m_linearKalman.statePre.at<track_t>(4) = 0;      // ax
-	m_linearKalman.statePre.at<track_t>(5) = 0;      // ay
-
-	m_linearKalman.statePost.at<track_t>(0) = xy0.x;
-	m_linearKalman.statePost.at<track_t>(1) = xy0.y;
-	m_linearKalman.statePost.at<track_t>(2) = xyv0.x;
-	m_linearKalman.statePost.at<track_t>(3) = xyv0.y;
-	m_linearKalman.statePost.at<track_t>(4) = 0;
-	m_linearKalman.statePost.at<track_t>(5) = 0;
-
-	cv::setIdentity(m_linearKalman.measurementMatrix);
-
-	track_t n1 = pow(m_deltaTime, 4.f) / 4.f;
-	track_t n2 = pow(m_deltaTime, 3.f) / 2.f;
-	track_t n3 = pow(m_deltaTime, 2.f);
-	m_linearKalman.processNoiseCov = (cv::Mat_<track_t>(6, 6) <<
-		n1, 0, n2, 0, n2, 0,
-		0, n1, 0, n2, 0, n2,
-		n2, 0, n3, 0, n3, 0,
-		0, n2, 0, n3, 0, n3,
-		0, 0, n2, 0, n3, 0,
-		0, 0, 0, n2, 0, n3);
-
-	m_linearKalman.processNoiseCov *= m_accelNoiseMag;
-
-	cv::setIdentity(m_linearKalman.measurementNoiseCov, cv::Scalar::all(0.1));
-
-	cv::setIdentity(m_linearKalman.errorCovPost, cv::Scalar::all(.1));
-
-	m_initialPoints.reserve(MIN_INIT_VALS);
-
-	m_initialized = true;
+	    0, 0, 0,  0,  0,   1 };
+
+
+	const track_t n1 = accelNoiseMag * pow(deltaTime, 4.f) / 4.f;
+	const track_t n2 = accelNoiseMag * pow(deltaTime, 3.f) / 2.f;
+	const track_t n3 = accelNoiseMag * pow(deltaTime, 2.f);
+	const track_t n4 = accelNoiseMag * pow(deltaTime, 2.f) / 2.f;
+	const track_t n5 = accelNoiseMag * deltaTime;
+	const track_t n6 = accelNoiseMag;
+	// Q = G * G^T * accelNoiseMag, G = (dt^2 / 2, dt, 1): symmetric and positive semidefinite, so the filter doesn't diverge
+	const track_t processNoise[] = {
+		n1, 0,  n2, 0,  n4, 0,
+		0,  n1, 0,  n2, 0,  n4,
+		n2, 0,  n3, 0,  n5, 0,
+		0,  n2, 0,  n3, 0,  n5,
+		n4, 0,  n5, 0,  n6, 0,
+		0,  n4, 0,  n5, 0,  n6 };
+
+	std::copy(std::begin(transition), std::end(transition), transitionOut);
+	std::copy(std::begin(processNoise), std::end(processNoise), processNoiseOut);
 }
 
 //---------------------------------------------------------------------------
-void TKalmanFilter::CreateLinearAcceleration(cv::Rect_<track_t> rect0, Point_t rectv0)
+template<>
+void TKalmanFilterT<tracking::ConstantAcceleration, tracking::RectMeasurement>::MakeModel(track_t deltaTime, track_t accelNoiseMag, track_t* transitionOut, track_t* processNoiseOut)
 {
-	// 12 state variables (x, y, vx, vy, ax, ay, width, height, vw, vh, aw, ah), 4 measurements (x, y, width, height)
-	m_linearKalman.init(12, 4, 0, El_t);
+	// 12 state variables (x, y, width, height, vx, vy, vw, vh, ax, ay, aw, ah), 4 measurements (x, y, width, height)
 	// Transition cv::Matrix
-	const track_t dt = m_deltaTime;
-	const track_t dt2 = 0.5f * m_deltaTime * m_deltaTime;
-	m_linearKalman.transitionMatrix = (cv::Mat_<track_t>(12, 12) <<
-		1, 0, 0, 0, dt, 0,  0,  0,  dt2, 0,   dt2, 0,
-		0, 1, 0, 0, 0,  dt, 0,  0,  0,   dt2, 0,   dt2,
+	const track_t dt = deltaTime;
+	const track_t dt2 = 0.5f * deltaTime * deltaTime;
+	const track_t transition[] = {
+		1, 0, 0, 0, dt, 0,  0,  0,  dt2, 0,   0,   0,
+		0, 1, 0, 0, 0,  dt, 0,  0,  0,   dt2, 0,   0,
 		0, 0, 1, 0, 0,  0,  dt, 0,  0,   0,   dt2, 0,
 		0, 0, 0, 1, 0,  0,  0,  dt, 0,   0,   0,   dt2,
 		0, 0, 0, 0, 1,  0,  0,  0,  dt,  0,   0,   0,
@@ -211,697 +132,495 @@ void TKalmanFilter::CreateLinearAcceleration(cv::Rect_<track_t> rect0, Point_t r
 		0, 0, 0, 0, 0,  0,  0,  0,  1,   0,   0,   0,
 		0, 0, 0, 0, 0,  0,  0,  0,  0,   1,   0,   0,
 		0, 0, 0, 0, 0,  0,  0,  0,  0,   0,   1,   0,
-		0, 0, 0, 0, 0,  0,  0,  0,  0,   0,   0,   1);
-
-	// init...
-	m_linearKalman.statePre.at<track_t>(0) = rect0.x;      // x
-	m_linearKalman.statePre.at<track_t>(1) = rect0.y;      // y
-	m_linearKalman.statePre.at<track_t>(2) = rect0.width;  // width
-	m_linearKalman.statePre.at<track_t>(3) = rect0.height; // height
-	m_linearKalman.statePre.at<track_t>(4) = rectv0.x;     // dx
-	m_linearKalman.statePre.at<track_t>(5) = rectv0.y;     // dy
-	m_linearKalman.statePre.at<track_t>(6) = 0;            // dw
-	m_linearKalman.statePre.at<track_t>(7) = 0;            // dh
-	m_linearKalman.statePre.at<track_t>(8) = 0;            // ax
-	m_linearKalman.statePre.at<track_t>(9) = 0;            // ay
-	m_linearKalman.statePre.at<track_t>(10) = 0;           // aw
-	m_linearKalman.statePre.at<track_t>(11) = 0;           // ah
-
-	m_linearKalman.statePost.at<track_t>(0) = rect0.x;
-	m_linearKalman.statePost.at<track_t>(1) = rect0.y;
-	m_linearKalman.statePost.at<track_t>(2) = rect0.width;
-	m_linearKalman.statePost.at<track_t>(3) = rect0.height;
-	m_linearKalman.statePost.at<track_t>(4) = rectv0.x;
-	m_linearKalman.statePost.at<track_t>(5) = rectv0.y;
-	m_linearKalman.statePost.at<track_t>(6) = 0;
-	m_linearKalman.statePost.at<track_t>(7) = 0;
-	m_linearKalman.statePost.at<track_t>(8) = 0;
-	m_linearKalman.statePost.at<track_t>(9) = 0;
-	m_linearKalman.statePost.at<track_t>(10) = 0;
-	m_linearKalman.statePost.at<track_t>(11) = 0;
-
-	cv::setIdentity(m_linearKalman.measurementMatrix);
-
-	track_t n1 = pow(m_deltaTime, 4.f) / 4.f;
-	track_t n2 = pow(m_deltaTime, 3.f) / 2.f;
-	track_t n3 = pow(m_deltaTime, 2.f);
-	m_linearKalman.processNoiseCov = (cv::Mat_<track_t>(12, 12) <<
-		n1, 0,  0,  0,  n2, 0,  0,  0,  n2, 0,  n2, 0,
-		0,  n1, 0,  0,  0,  n2, 0,  0,  0,  n2, 0,  n2,
-		0,  0,  n1, 0,  0,  0,  n2, 0,  0,  0,  n2, 0,
-		0,  0,  0,  n1, 0,  0,  0,  n2, 0,  0,  0,  n2,
-		n2, 0,  0,  0,  n3, 0,  0,  0,  n3, 0,  n3, 0,
-		0,  n2, 0,  0,  0,  n3, 0,  0,  0,  n3, 0,  n3,
-		0,  0,  n2, 0,  0,  0,  n3, 0,  0,  0,  n3, 0,
-		0,  0,  0,  n2, 0,  0,  0,  n3, 0,  0,  0,  n3,
-		n2, 0,  0,  0,  n3, 0,  0,  0,  n3, 0,  0,  0,
-		0,  n2, 0,  0,  0,  n3, 0,  0,  0,  n3, 0,  0,
-		0,  0,  n2, 0,  0,  0,  n3, 0,  0,  0,  n3, 0,
-		0,  0,  0,  n2, 0,  0,  0,  n3, 0,  0,  0,  n3);
-
-	m_linearKalman.processNoiseCov *= m_accelNoiseMag;
-
-	cv::setIdentity(m_linearKalman.measurementNoiseCov, cv::Scalar::all(0.1));
-
-	cv::setIdentity(m_linearKalman.errorCovPost, cv::Scalar::all(.1));
-
-	m_initialRects.reserve(MIN_INIT_VALS);
-
-	m_initialized = true;
+		0, 0, 0, 0, 0,  0,  0,  0,  0,   0,   0,   1 };
+
+
+	const track_t n1 = accelNoiseMag * pow(deltaTime, 4.f) / 4.f;
+	const track_t n2 = accelNoiseMag * pow(deltaTime, 3.f) / 2.f;
+	const track_t n3 = accelNoiseMag * pow(deltaTime, 2.f);
+	const track_t n4 = accelNoiseMag * pow(deltaTime, 2.f) / 2.f;
+	const track_t n5 = accelNoiseMag * deltaTime;
+	const track_t n6 = accelNoiseMag;
+	// Q = G * G^T * accelNoiseMag, G = (dt^2 / 2, dt, 1) for every measured value
+	const track_t processNoise[] = {
+		n1, 0,  0,  0,  n2, 0,  0,  0,  n4, 0,  0,  0,
+		0,  n1, 0,  0,  0,  n2, 0,  0,  0,  n4, 0,  0,
+		0,  0,  n1, 0,  0,  0,  n2, 0,  0,  0,  n4, 0,
+		0,  0,  0,  n1, 0,  0,  0,  n2, 0,  0,  0,  n4,
+		n2, 0,  0,  0,  n3, 0,  0,  0,  n5, 0,  0,  0,
+		0,  n2, 0,  0,  0,  n3, 0,  0,  0,  n5, 0,  0,
+		0,  0,  n2, 0,  0,  0,  n3, 0,  0,  0,  n5, 0,
+		0,  0,  0,  n2, 0,  0,  0,  n3, 0,  0,  0,  n5,
+		n4, 0,  0,  0,  n5, 0,  0,  0,  n6, 0,  0,  0,
+		0,  n4, 0,  0,  0,  n5, 0,  0,  0,  n6, 0,  0,
+		0,  0,  n4, 0,  0,  0,  n5, 0,  0,  0,  n6, 0,
+		0,  0,  0,  n4, 0,  0,  0,  n5, 0,  0,  0,  n6 };
+
+	std::copy(std::begin(transition), std::end(transition), transitionOut);
+	std::copy(std::begin(processNoise), std::end(processNoise), processNoiseOut);
 }
 
-#ifdef USE_OCV_UKF
 //---------------------------------------------------------------------------
-class AcceleratedModel: public cv::tracking::UkfSystemModel
+template<class MODEL, class MEASUREMENT>
+void TKalmanFilterT<MODEL, MEASUREMENT>::Create(const meas_t& value0, cv::Vec<track_t, 2> velocity0)
 {
-public:
-    AcceleratedModel(track_t deltaTime, bool rectModel)
-        :
-          cv::tracking::UkfSystemModel(),
-          m_deltaTime(deltaTime),
-          m_rectModel(rectModel)
+    // State: (measured values, vx, vy, ...)
+    typename engine_t::state_t state0 = engine_t::state_t::zeros();
+    for (int i = 0; i < MEAS_SIZE; ++i)
     {
+        state0(i) = value0(i);
     }
+    state0(MEAS_SIZE) = velocity0[0];
+    state0(MEAS_SIZE + 1) = velocity0[1];
 
-    void stateConversionFunction(const cv::Mat& x_k, const cv::Mat& u_k, const cv::Mat& v_k, cv::Mat& x_kplus1)
+    if constexpr (MODEL::LINEAR || std::is_same_v<MODEL, tracking::InteractingMultipleModel>)
+    {
+        ApplyModel(&state0);
+    }
+    else
     {
-        track_t x0 = x_k.at<track_t>(0, 0);
-        track_t y0 = x_k.at<track_t>(1, 0);
-        track_t vx0 = x_k.at<track_t>(2, 0);
-        track_t vy0 = x_k.at<track_t>(3, 0);
-        track_t ax0 = x_k.at<track_t>(4, 0);
-        track_t ay0 = x_k.at<track_t>(5, 0);
-
-        x_kplus1.at<track_t>(0, 0) = x0 + vx0 * m_deltaTime + ax0 * sqr(m_deltaTime) / 2;
-        x_kplus1.at<track_t>(1, 0) = y0 + vy0 * m_deltaTime + ay0 * sqr(m_deltaTime) / 2;
-        x_kplus1.at<track_t>(2, 0) = vx0 + ax0 * m_deltaTime;
-        x_kplus1.at<track_t>(3, 0) = vy0 + ay0 * m_deltaTime;
-        x_kplus1.at<track_t>(4, 0) = ax0;
-        x_kplus1.at<track_t>(5, 0) = ay0;
-
-        if (m_rectModel)
+        typename engine_t::state_t processNoise;
+        meas_t measurementNoise;
+        track_t errorCov = 0;
+        if constexpr (MEAS_SIZE == 2)
         {
-            x_kplus1.at<track_t>(6, 0) = x_k.at<track_t>(6, 0);
-            x_kplus1.at<track_t>(7, 0) = x_k.at<track_t>(7, 0);
+            const track_t noise[] = { 1e-14f, 1e-14f, 1e-6f, 1e-6f, 1e-6f, 1e-6f };
+            processNoise = typename engine_t::state_t(noise);
+            measurementNoise = meas_t::all(1e-6f);
+            errorCov = 1e-6f;
         }
-
-        if (v_k.size() == u_k.size())
-            x_kplus1 += v_k + u_k;
         else
-            x_kplus1 += v_k;
-    }
-
-    void measurementFunction(const cv::Mat& x_k, const cv::Mat& n_k, cv::Mat& z_k)
-    {
-        track_t x0 = x_k.at<track_t>(0, 0);
-        track_t y0 = x_k.at<track_t>(1, 0);
-        track_t vx0 = x_k.at<track_t>(2, 0);
-        track_t vy0 = x_k.at<track_t>(3, 0);
-        track_t ax0 = x_k.at<track_t>(4, 0);
-        track_t ay0 = x_k.at<track_t>(5, 0);
-
-        z_k.at<track_t>(0, 0) = x0 + vx0 * m_deltaTime + ax0 * sqr(m_deltaTime) / 2 + n_k.at<track_t>(0, 0);
-        z_k.at<track_t>(1, 0) = y0 + vy0 * m_deltaTime + ay0 * sqr(m_deltaTime) / 2 + n_k.at<track_t>(1, 0);
-
-        if (m_rectModel)
         {
-            z_k.at<track_t>(2, 0) = x_k.at<track_t>(6, 0);
-            z_k.at<track_t>(3, 0) = x_k.at<track_t>(7, 0);
+            processNoise = engine_t::state_t::all(1e-3f);
+            measurementNoise = meas_t::all(1e-3f);
+            errorCov = 1e-3f;
         }
-    }
-
-private:
-    track_t m_deltaTime;
-    bool m_rectModel;
-};
 
-//---------------------------------------------------------------------------
-void TKalmanFilter::CreateUnscented(Point_t xy0, Point_t xyv0)
-{
-    int MP = 2;
-    int DP = 6;
-    int CP = 0;
-
-    cv::Mat processNoiseCov = cv::Mat::zeros(DP, DP, Mat_t(1));
-    processNoiseCov.at<track_t>(0, 0) = 1e-14f;
-    processNoiseCov.at<track_t>(1, 1) = 1e-14f;
-    processNoiseCov.at<track_t>(2, 2) = 1e-6f;
-    processNoiseCov.at<track_t>(3, 3) = 1e-6f;
-    processNoiseCov.at<track_t>(4, 4) = 1e-6f;
-    processNoiseCov.at<track_t>(5, 5) = 1e-6f;
-
-    cv::Mat measurementNoiseCov = cv::Mat::zeros(MP, MP, Mat_t(1));
-    measurementNoiseCov.at<track_t>(0, 0) = 1e-6f;
-    measurementNoiseCov.at<track_t>(1, 1) = 1e-6f;
-
-    cv::Mat initState(DP, 1, Mat_t(1));
-    initState.at<track_t>(0, 0) = xy0.x;
-    initState.at<track_t>(1, 0) = xy0.y;
-    initState.at<track_t>(2, 0) = xyv0.x;
-    initState.at<track_t>(3, 0) = xyv0.y;
-    initState.at<track_t>(4, 0) = 0;
-    initState.at<track_t>(5, 0) = 0;
-
-    cv::Mat P = 1e-6f * cv::Mat::eye(DP, DP, Mat_t(1));
-
-    cv::Ptr<AcceleratedModel> model(new AcceleratedModel(m_deltaTime, false));
-    cv::tracking::UnscentedKalmanFilterParams params(DP, MP, CP, 0, 0, model);
-    params.dataType = Mat_t(1);
-    params.stateInit = initState.clone();
-    params.errorCovInit = P.clone();
-    params.measurementNoiseCov = measurementNoiseCov.clone();
-    params.processNoiseCov = processNoiseCov.clone();
-
-    params.alpha = 1.0;
-    params.beta = 2.0;
-    params.k = -2.0;
-
-    m_uncsentedKalman = cv::tracking::createUnscentedKalmanFilter(params);
-
-    m_initialized = true;
+        m_kalman.Init(state0, processNoise, measurementNoise, errorCov, m_deltaTime);
+    }
 }
 
 //---------------------------------------------------------------------------
-void TKalmanFilter::CreateUnscented(cv::Rect_<track_t> rect0, Point_t rectv0)
+template<class MODEL, class MEASUREMENT>
+void TKalmanFilterT<MODEL, MEASUREMENT>::ApplyModel(const typename engine_t::state_t* state0)
 {
-    int MP = 4;
-    int DP = 8;
-    int CP = 0;
-
-    cv::Mat processNoiseCov = cv::Mat::zeros(DP, DP, Mat_t(1));
-    processNoiseCov.at<track_t>(0, 0) = 1e-3f;
-    processNoiseCov.at<track_t>(1, 1) = 1e-3f;
-    processNoiseCov.at<track_t>(2, 2) = 1e-3f;
-    processNoiseCov.at<track_t>(3, 3) = 1e-3f;
-    processNoiseCov.at<track_t>(4, 4) = 1e-3f;
-    processNoiseCov.at<track_t>(5, 5) = 1e-3f;
-    processNoiseCov.at<track_t>(6, 6) = 1e-3f;
-    processNoiseCov.at<track_t>(7, 7) = 1e-3f;
-
-    cv::Mat measurementNoiseCov = cv::Mat::zeros(MP, MP, Mat_t(1));
-    measurementNoiseCov.at<track_t>(0, 0) = 1e-3f;
-    measurementNoiseCov.at<track_t>(1, 1) = 1e-3f;
-    measurementNoiseCov.at<track_t>(2, 2) = 1e-3f;
-    measurementNoiseCov.at<track_t>(3, 3) = 1e-3f;
-
-    cv::Mat initState(DP, 1, Mat_t(1));
-    initState.at<track_t>(0, 0) = rect0.x;
-    initState.at<track_t>(1, 0) = rect0.y;
-    initState.at<track_t>(2, 0) = rectv0.x;
-    initState.at<track_t>(3, 0) = rectv0.y;
-    initState.at<track_t>(4, 0) = 0;
-    initState.at<track_t>(5, 0) = 0;
-    initState.at<track_t>(6, 0) = rect0.width;
-    initState.at<track_t>(7, 0) = rect0.height;
-
-    cv::Mat P = 1e-3f * cv::Mat::eye(DP, DP, Mat_t(1));
-
-    cv::Ptr<AcceleratedModel> model(new AcceleratedModel(m_deltaTime, true));
-    cv::tracking::UnscentedKalmanFilterParams params(DP, MP, CP, 0, 0, model);
-    params.dataType = Mat_t(1);
-    params.stateInit = initState.clone();
-    params.errorCovInit = P.clone();
-    params.measurementNoiseCov = measurementNoiseCov.clone();
-    params.processNoiseCov = processNoiseCov.clone();
-
-    params.alpha = 1;
-    params.beta = 2.0;
-    params.k = -2.0;
-
-    m_uncsentedKalman = cv::tracking::createUnscentedKalmanFilter(params);
-
-    m_initialized = true;
+    // Init the filter with state0 or only change the model for the current time step
+    if constexpr (std::is_same_v<MODEL, tracking::InteractingMultipleModel>)
+    {
+        typedef TKalmanFilterT<tracking::ConstantVelocity, MEASUREMENT> cv_filter_t;
+        typedef TKalmanFilterT<tracking::ConstantAcceleration, MEASUREMENT> ca_filter_t;
+        cv::Matx<track_t, 2 * MEAS_SIZE, 2 * MEAS_SIZE> cvTransition;
+        cv::Matx<track_t, 2 * MEAS_SIZE, 2 * MEAS_SIZE> cvProcessNoise;
+        typename engine_t::cov_t caTransition;
+        typename engine_t::cov_t caProcessNoise;
+        cv_filter_t::MakeModel(m_deltaTime, m_accelNoiseMag, cvTransition.val, cvProcessNoise.val);
+        ca_filter_t::MakeModel(m_deltaTime, m_accelNoiseMag, caTransition.val, caProcessNoise.val);
+        if (state0)
+            m_kalman.Init(cvTransition.val, cvProcessNoise.val, caTransition.val, caProcessNoise.val, state0->val, 0.1f, 0.1f);
+        else
+            m_kalman.SetModel(cvTransition.val, cvProcessNoise.val, caTransition.val, caProcessNoise.val);
+    }
+    else
+    {
+        typename engine_t::cov_t transition;
+        typename engine_t::cov_t processNoise;
+        MakeModel(m_deltaTime, m_accelNoiseMag, transition.val, processNoise.val);
+        if (state0)
+            m_kalman.Init(transition.val, processNoise.val, state0->val, 0.1f, 0.1f);
+        else
+            m_kalman.SetModel(transition.val, processNoise.val);
+    }
 }
 
 //---------------------------------------------------------------------------
-void TKalmanFilter::CreateAugmentedUnscented(Point_t xy0, Point_t xyv0)
+template<class MODEL, class MEASUREMENT>
+void TKalmanFilterT<MODEL, MEASUREMENT>::SetDeltaTime(track_t deltaTime)
 {
-    int MP = 2;
-    int DP = 6;
-    int CP = 0;
-
-    cv::Mat processNoiseCov = cv::Mat::zeros(DP, DP, Mat_t(1));
-    processNoiseCov.at<track_t>(0, 0) = 1e-14f;
-    processNoiseCov.at<track_t>(1, 1) = 1e-14f;
-    processNoiseCov.at<track_t>(2, 2) = 1e-6f;
-    processNoiseCov.at<track_t>(3, 3) = 1e-6f;
-    processNoiseCov.at<track_t>(4, 4) = 1e-6f;
-    processNoiseCov.at<track_t>(5, 5) = 1e-6f;
-
-    cv::Mat measurementNoiseCov = cv::Mat::zeros(MP, MP, Mat_t(1));
-    measurementNoiseCov.at<track_t>(0, 0) = 1e-6f;
-    measurementNoiseCov.at<track_t>(1, 1) = 1e-6f;
-
-    cv::Mat initState(DP, 1, Mat_t(1));
-    initState.at<track_t>(0, 0) = xy0.x;
-    initState.at<track_t>(1, 0) = xy0.y;
-    initState.at<track_t>(2, 0) = xyv0.x;
-    initState.at<track_t>(3, 0) = xyv0.y;
-    initState.at<track_t>(4, 0) = 0;
-    initState.at<track_t>(5, 0) = 0;
-
-    cv::Mat P = 1e-6f * cv::Mat::eye(DP, DP, Mat_t(1));
-
-    cv::Ptr<AcceleratedModel> model(new AcceleratedModel(m_deltaTime, false));
-    cv::tracking::AugmentedUnscentedKalmanFilterParams params(DP, MP, CP, 0, 0, model);
-    params.dataType = Mat_t(1);
-    params.stateInit = initState.clone();
-    params.errorCovInit = P.clone();
-    params.measurementNoiseCov = measurementNoiseCov.clone();
-    params.processNoiseCov = processNoiseCov.clone();
-
-    params.alpha = 1;
-    params.beta = 2.0;
-    params.k = -2.0;
-
-    m_uncsentedKalman = cv::tracking::createAugmentedUnscentedKalmanFilter(params);
-
-    m_initialized = true;
+    // The same time step: keep the inertia correction
+    if (std::abs(deltaTime - m_deltaTimeMin) <= 1e-3f * m_deltaTimeMin)
+        return;
+
+    m_deltaTime = deltaTime;
+    m_deltaTimeMin = deltaTime;
+    m_deltaTimeMax = 2 * deltaTime;
+    m_deltaStep = (m_deltaTimeMax - m_deltaTimeMin) / m_deltaStepsCount;
+
+    if (m_initialized)
+    {
+        if constexpr (MODEL::LINEAR || std::is_same_v<MODEL, tracking::InteractingMultipleModel>)
+            ApplyModel(nullptr);
+        else
+        {
+            m_kalman.SetDeltaTime(m_deltaTime);
+        }
+    }
 }
 
 //---------------------------------------------------------------------------
-void TKalmanFilter::CreateAugmentedUnscented(cv::Rect_<track_t> rect0, Point_t rectv0)
+template<class MODEL, class MEASUREMENT>
+TKalmanFilterT<MODEL, MEASUREMENT>::TKalmanFilterT(
+        track_t deltaTime, // time increment (lower values makes target more "massive")
+        track_t accelNoiseMag
+        )
+    :
+      m_accelNoiseMag(accelNoiseMag),
+      m_deltaTime(deltaTime),
+      m_deltaTimeMin(deltaTime),
+      m_deltaTimeMax(2 * deltaTime)
 {
-    int MP = 4;
-    int DP = 8;
-    int CP = 0;
-
-    cv::Mat processNoiseCov = cv::Mat::zeros(DP, DP, Mat_t(1));
-    processNoiseCov.at<track_t>(0, 0) = 1e-3f;
-    processNoiseCov.at<track_t>(1, 1) = 1e-3f;
-    processNoiseCov.at<track_t>(2, 2) = 1e-3f;
-    processNoiseCov.at<track_t>(3, 3) = 1e-3f;
-    processNoiseCov.at<track_t>(4, 4) = 1e-3f;
-    processNoiseCov.at<track_t>(5, 5) = 1e-3f;
-    processNoiseCov.at<track_t>(6, 6) = 1e-3f;
-    processNoiseCov.at<track_t>(7, 7) = 1e-3f;
-
-    cv::Mat measurementNoiseCov = cv::Mat::zeros(MP, MP, Mat_t(1));
-    measurementNoiseCov.at<track_t>(0, 0) = 1e-3f;
-    measurementNoiseCov.at<track_t>(1, 1) = 1e-3f;
-    measurementNoiseCov.at<track_t>(2, 2) = 1e-3f;
-    measurementNoiseCov.at<track_t>(3, 3) = 1e-3f;
-
-    cv::Mat initState(DP, 1, Mat_t(1));
-    initState.at<track_t>(0, 0) = rect0.x;
-    initState.at<track_t>(1, 0) = rect0.y;
-    initState.at<track_t>(2, 0) = rectv0.x;
-    initState.at<track_t>(3, 0) = rectv0.y;
-    initState.at<track_t>(4, 0) = 0;
-    initState.at<track_t>(5, 0) = 0;
-    initState.at<track_t>(6, 0) = rect0.width;
-    initState.at<track_t>(7, 0) = rect0.height;
-
-    cv::Mat P = 1e-3f * cv::Mat::eye(DP, DP, Mat_t(1));
-
-    cv::Ptr<AcceleratedModel> model(new AcceleratedModel(m_deltaTime, true));
-    cv::tracking::AugmentedUnscentedKalmanFilterParams params(DP, MP, CP, 0, 0, model);
-    params.dataType = Mat_t(1);
-    params.stateInit = initState.clone();
-    params.errorCovInit = P.clone();
-    params.measurementNoiseCov = measurementNoiseCov.clone();
-    params.processNoiseCov = processNoiseCov.clone();
-
-    params.alpha = 1;
-    params.beta = 2.0;
-    params.k = -2.0;
-
-    m_uncsentedKalman = cv::tracking::createAugmentedUnscentedKalmanFilter(params);
-
-    m_initialized = true;
+    m_deltaStep = (m_deltaTimeMax - m_deltaTimeMin) / m_deltaStepsCount;
+    m_initialValues.reserve(MIN_INIT_VALS);
 }
-#endif
 
 //---------------------------------------------------------------------------
-Point_t TKalmanFilter::GetPointPrediction()
+template<class MODEL, class MEASUREMENT>
+typename TKalmanFilterT<MODEL, MEASUREMENT>::meas_t TKalmanFilterT<MODEL, MEASUREMENT>::Predict()
 {
     if (m_initialized)
-    {
-        cv::Mat prediction;
+        m_lastResult = Measured(m_kalman.Predict());
 
-        switch (m_type)
-        {
-        case tracking::KalmanLinear:
-            prediction = m_linearKalman.predict();
-            break;
-
-        case tracking::KalmanUnscented:
-        case tracking::KalmanAugmentedUnscented:
-#ifdef USE_OCV_UKF
-            prediction = m_uncsentedKalman->predict();
-#else
-            prediction = m_linearKalman.predict();
-            std::cerr << "UnscentedKalmanFilter was disabled in CMAKE! Set KalmanLinear in constructor." << std::endl;
-#endif
-            break;
-        }
-
-        m_lastPointResult = Point_t(prediction.at<track_t>(0), prediction.at<track_t>(1));
-    }
-    return m_lastPointResult;
+    return m_lastResult;
 }
 
 //---------------------------------------------------------------------------
-Point_t TKalmanFilter::Update(Point_t pt, bool dataCorrect)
+template<class MODEL, class MEASUREMENT>
+typename TKalmanFilterT<MODEL, MEASUREMENT>::meas_t TKalmanFilterT<MODEL, MEASUREMENT>::Update(const meas_t& value, bool dataCorrect)
 {
     if (!m_initialized)
     {
-        if (m_initialPoints.size() < MIN_INIT_VALS)
+        if (m_initialValues.size() < MIN_INIT_VALS)
         {
             if (dataCorrect)
             {
-                m_initialPoints.push_back(pt);
-                m_lastPointResult = pt;
+                m_initialValues.push_back(value);
+                m_lastResult = value;
             }
         }
-        if (m_initialPoints.size() == MIN_INIT_VALS)
+        if (m_initialValues.size() == MIN_INIT_VALS)
         {
+            // Position and velocity from the linear regression, the other values (size) are averaged
+            std::vector<Point_t> initialPoints;
+            initialPoints.reserve(MIN_INIT_VALS);
+            meas_t value0 = meas_t::zeros();
+            for (const auto& v : m_initialValues)
+            {
+                initialPoints.emplace_back(v(0), v(1));
+                for (int i = 2; i < MEAS_SIZE; ++i)
+                {
+                    value0(i) += v(i);
+                }
+            }
+            for (int i = 2; i < MEAS_SIZE; ++i)
+            {
+                value0(i) /= MIN_INIT_VALS;
+            }
+
             track_t kx = 0;
             track_t bx = 0;
             track_t ky = 0;
             track_t by = 0;
-            get_lin_regress_params(m_initialPoints, 0, MIN_INIT_VALS, kx, bx, ky, by);
-            Point_t xy0(kx * (MIN_INIT_VALS - 1) + bx, ky * (MIN_INIT_VALS - 1) + by);
-            Point_t xyv0(kx, ky);
-
-            switch (m_type)
-            {
-            case tracking::KalmanLinear:
-                if (m_useAcceleration)
-					CreateLinearAcceleration(xy0, xyv0);
-				else
-					CreateLinear(xy0, xyv0);
-                break;
-
-            case tracking::KalmanUnscented:
-#ifdef USE_OCV_UKF
-                CreateUnscented(xy0, xyv0);
-#else
-				if (m_useAcceleration)
-					CreateLinearAcceleration(xy0, xyv0);
-				else
-					CreateLinear(xy0, xyv0);
-                std::cerr << "UnscentedKalmanFilter was disabled in CMAKE! Set KalmanLinear in constructor." << std::endl;
-#endif
-                break;
+            get_lin_regress_params(initialPoints, 0, MIN_INIT_VALS, kx, bx, ky, by);
+            value0(0) = kx * (MIN_INIT_VALS - 1) + bx;
+            value0(1) = ky * (MIN_INIT_VALS - 1) + by;
 
-            case tracking::KalmanAugmentedUnscented:
-#ifdef USE_OCV_UKF
-                CreateAugmentedUnscented(xy0, xyv0);
-#else
-				if (m_useAcceleration)
-					CreateLinearAcceleration(xy0, xyv0);
-				else
-					CreateLinear(xy0, xyv0);
-                std::cerr << "AugmentedUnscentedKalmanFilter was disabled in CMAKE! Set KalmanLinear in constructor." << std::endl;
-#endif
-                break;
-            }
+            Create(value0, cv::Vec<track_t, 2>(kx, ky));
+            m_lastResult = value0;
             m_lastDist = 0;
+            m_initialized = true;
         }
     }
 
     if (m_initialized)
     {
-        cv::Mat measurement(2, 1, Mat_t(1));
-        if (!dataCorrect)
-        {
-            measurement.at<track_t>(0) = m_lastPointResult.x;  //update using prediction
-            measurement.at<track_t>(1) = m_lastPointResult.y;
-        }
-        else
-        {
-            measurement.at<track_t>(0) = pt.x;  //update using measurements
-            measurement.at<track_t>(1) = pt.y;
-        }
-        // Correction
-        cv::Mat estimated;
-        switch (m_type)
-        {
-        case tracking::KalmanLinear:
+        // Correction: update using measurements or using prediction
+        m_lastResult = Measured(m_kalman.Correct(dataCorrect ? value : m_lastResult));
+
+        // Inertia correction
+        if constexpr (std::is_same_v<MODEL, tracking::ConstantVelocity>)
         {
-            estimated = m_linearKalman.correct(measurement);
-
-            // Inertia correction
-			if (!m_useAcceleration)
-			{
-				track_t currDist = sqrtf(sqr(estimated.at<track_t>(0) - pt.x) + sqr(estimated.at<track_t>(1) - pt.y));
-				if (currDist > m_lastDist)
-					m_deltaTime = std::min(m_deltaTime + m_deltaStep, m_deltaTimeMax);
-				else
-					m_deltaTime = std::max(m_deltaTime - m_deltaStep, m_deltaTimeMin);
-
-				m_lastDist = currDist;
-
-				m_linearKalman.transitionMatrix.at<track_t>(0, 2) = m_deltaTime;
-				m_linearKalman.transitionMatrix.at<track_t>(1, 3) = m_deltaTime;
-			}
-            break;
-        }
+            track_t currDist = 0;
+            for (int i = 0; i < MEAS_SIZE; ++i)
+            {
+                currDist += sqr(m_lastResult(i) - value(i));
+            }
+            currDist = sqrtf(currDist);
+            if (currDist > m_lastDist)
+                m_deltaTime = std::min(m_deltaTime + m_deltaStep, m_deltaTimeMax);
+            else
+                m_deltaTime = std::max(m_deltaTime - m_deltaStep, m_deltaTimeMin);
 
-        case tracking::KalmanUnscented:
-        case tracking::KalmanAugmentedUnscented:
-#ifdef USE_OCV_UKF
-            estimated = m_uncsentedKalman->correct(measurement);
-#else
-            estimated = m_linearKalman.correct(measurement);
-            std::cerr << "UnscentedKalmanFilter was disabled in CMAKE! Set KalmanLinear in constructor." << std::endl;
-#endif
-            break;
-        }
+            m_lastDist = currDist;
 
-        m_lastPointResult.x = estimated.at<track_t>(0);   //update using measurements
-        m_lastPointResult.y = estimated.at<track_t>(1);
+            m_kalman.SetVelocityTransition(m_deltaTime);
+        }
     }
     else
     {
         if (dataCorrect)
-            m_lastPointResult = pt;
+            m_lastResult = value;
     }
-    return m_lastPointResult;
+    return m_lastResult;
 }
 
 //---------------------------------------------------------------------------
-cv::Rect TKalmanFilter::GetRectPrediction()
+template<class MODEL, class MEASUREMENT>
+cv::Vec<track_t, 2> TKalmanFilterT<MODEL, MEASUREMENT>::GetVelocity() const
 {
-    if (m_initialized)
+    return m_initialized ? m_kalman.GetVelocity() : cv::Vec<track_t, 2>(0, 0);
+}
+
+//---------------------------------------------------------------------------
+template<class MODEL, class MEASUREMENT>
+cv::Matx<track_t, 2, 2> TKalmanFilterT<MODEL, MEASUREMENT>::GetPositionCov() const
+{
+    return m_initialized ? m_kalman.PositionCov() : cv::Matx<track_t, 2, 2>::zeros();
+}
+
+//---------------------------------------------------------------------------
+///
+/// \brief The TKalmanFilter::IFilter class
+///
+class TKalmanFilter::IFilter
+{
+public:
+    virtual ~IFilter() = default;
+
+    virtual Point_t GetPointPrediction() = 0;
+    virtual Point_t Update(Point_t pt, bool dataCorrect) = 0;
+
+    virtual cv::Rect GetRectPrediction() = 0;
+    virtual cv::Rect Update(cv::Rect rect, bool dataCorrect) = 0;
+
+    virtual cv::Vec<track_t, 2> GetVelocity() const = 0;
+    virtual cv::Matx<track_t, 2, 2> GetPositionCov() const = 0;
+
+    virtual void SetDeltaTime(track_t deltaTime) = 0;
+
+    ///
+    /// \brief PredictGroup
+    /// Predict for filters[0] (this filter) and the next filters with the same specialization
+    /// \param filters
+    /// \param count
+    /// \return Count of the predicted filters
+    ///
+    virtual size_t PredictGroup(TKalmanFilter* const* filters, size_t count) = 0;
+
+    ///
+    /// \brief Specialization
+    /// \return Unique tag of the FilterImpl specialization, it is compared without a virtual call or RTTI
+    ///
+    const void* Specialization() const
+    {
+        return m_specialization;
+    }
+
+protected:
+    const void* m_specialization = nullptr;
+};
+
+///
+/// \brief The TKalmanFilter::FilterImpl class
+/// TKalmanFilterT specialization behind the TKalmanFilter::IFilter interface
+///
+template<class MODEL, class MEASUREMENT>
+class TKalmanFilter::FilterImpl final : public TKalmanFilter::IFilter
+{
+public:
+    typedef TKalmanFilterT<MODEL, MEASUREMENT> filter_t;
+
+    FilterImpl(track_t deltaTime, track_t accelNoiseMag)
+        : m_filter(deltaTime, accelNoiseMag)
     {
-        cv::Mat prediction;
+        m_specialization = SpecializationTag();
+    }
+
+    Point_t GetPointPrediction() override
+    {
+        const auto prediction = m_filter.Predict();
+        return Point_t(prediction(0), prediction(1));
+    }
+
+    Point_t Update(Point_t pt, bool dataCorrect) override
+    {
+        auto measurement = m_filter.LastResult();
+        measurement(0) = pt.x;
+        measurement(1) = pt.y;
+        const auto estimated = m_filter.Update(measurement, dataCorrect);
+        return Point_t(estimated(0), estimated(1));
+    }
+
+    cv::Rect GetRectPrediction() override
+    {
+        const auto prediction = m_filter.Predict();
+        if constexpr (filter_t::MEAS_SIZE > 2)
+            return cv::Rect(static_cast<int>(prediction(0)), static_cast<int>(prediction(1)), static_cast<int>(prediction(2)), static_cast<int>(prediction(3)));
+        else
+            return cv::Rect(static_cast<int>(prediction(0)), static_cast<int>(prediction(1)), 0, 0);
+    }
+
+    cv::Rect Update(cv::Rect rect, bool dataCorrect) override
+    {
+        const track_t values[] = { static_cast<track_t>(rect.x), static_cast<track_t>(rect.y), static_cast<track_t>(rect.width), static_cast<track_t>(rect.height) };
+        typename filter_t::meas_t measurement(values);
+        const auto estimated = m_filter.Update(measurement, dataCorrect);
+        if constexpr (filter_t::MEAS_SIZE > 2)
+            return cv::Rect(static_cast<int>(estimated(0)), static_cast<int>(estimated(1)), static_cast<int>(estimated(2)), static_cast<int>(estimated(3)));
+        else
+            return cv::Rect(static_cast<int>(estimated(0)), static_cast<int>(estimated(1)), rect.width, rect.height);
+    }
+
+    cv::Vec<track_t, 2> GetVelocity() const override
+    {
+        return m_filter.GetVelocity();
+    }
+
+    cv::Matx<track_t, 2, 2> GetPositionCov() const override
+    {
+        return m_filter.GetPositionCov();
+    }
+
+    void SetDeltaTime(track_t deltaTime) override
+    {
+        m_filter.SetDeltaTime(deltaTime);
+    }
 
-        switch (m_type)
+    size_t PredictGroup(TKalmanFilter* const* filters, size_t count) override
+    {
+        // The run of the filters with the same specialization is predicted without virtual calls
+        size_t i = 0;
+        for (; i < count; ++i)
         {
-        case tracking::KalmanLinear:
-            prediction = m_linearKalman.predict();
-            break;
-
-        case tracking::KalmanUnscented:
-        case tracking::KalmanAugmentedUnscented:
-#ifdef USE_OCV_UKF
-            prediction = m_uncsentedKalman->predict();
-#else
-            prediction = m_linearKalman.predict();
-            std::cerr << "UnscentedKalmanFilter was disabled in CMAKE! Set KalmanLinear in constructor." << std::endl;
-#endif
-            break;
+            IFilter* filter = filters[i]->m_filter.get();
+            if (filter->Specialization() != m_specialization)
+                break;
+            static_cast<FilterImpl*>(filter)->m_filter.Predict();
         }
+        return i;
+    }
+
+private:
+    filter_t m_filter;
 
-        m_lastRectResult = cv::Rect_<track_t>(prediction.at<track_t>(0), prediction.at<track_t>(1), prediction.at<track_t>(2), prediction.at<track_t>(3));
+    static const void* SpecializationTag()
+    {
+        static const char tag = 0;
+        return &tag;
     }
-    return cv::Rect(static_cast<int>(m_lastRectResult.x), static_cast<int>(m_lastRectResult.y), static_cast<int>(m_lastRectResult.width), static_cast<int>(m_lastRectResult.height));
+};
+
+//---------------------------------------------------------------------------
+TKalmanFilter::TKalmanFilter(
+        tracking::KalmanType type,
+        bool useAcceleration,
+        bool filterRect,
+        track_t deltaTime,
+        track_t accelNoiseMag
+        )
+    :
+      m_filter(CreateFilter(type, useAcceleration, filterRect, deltaTime, accelNoiseMag))
+{
 }
 
 //---------------------------------------------------------------------------
-cv::Rect TKalmanFilter::Update(cv::Rect rect, bool dataCorrect)
+TKalmanFilter::~TKalmanFilter() = default;
+
+//---------------------------------------------------------------------------
+std::unique_ptr<TKalmanFilter::IFilter> TKalmanFilter::CreateFilter(tracking::KalmanType type, bool useAcceleration, bool filterRect, track_t deltaTime, track_t accelNoiseMag)
 {
-    if (!m_initialized)
+    switch (type)
     {
-        if (m_initialRects.size() < MIN_INIT_VALS)
-        {
-            if (dataCorrect)
-            {
-                m_initialRects.push_back(rect);
-                m_lastRectResult.x = static_cast<track_t>(rect.x);
-                m_lastRectResult.y = static_cast<track_t>(rect.y);
-                m_lastRectResult.width = static_cast<track_t>(rect.width);
-                m_lastRectResult.height = static_cast<track_t>(rect.height);
-            }
-        }
-        if (m_initialRects.size() == MIN_INIT_VALS)
-        {
-            std::vector<Point_t> initialPoints;
-            Point_t averageSize(0, 0);
-            for (const auto& r : m_initialRects)
-            {
-                initialPoints.emplace_back(static_cast<track_t>(r.x), static_cast<track_t>(r.y));
-                averageSize.x += r.width;
-                averageSize.y += r.height;
-            }
-            averageSize.x /= MIN_INIT_VALS;
-            averageSize.y /= MIN_INIT_VALS;
+    case tracking::KalmanLinear:
+        break;
 
-            track_t kx = 0;
-            track_t bx = 0;
-            track_t ky = 0;
-            track_t by = 0;
-            get_lin_regress_params(initialPoints, 0, MIN_INIT_VALS, kx, bx, ky, by);
-            cv::Rect_<track_t> rect0(kx * (MIN_INIT_VALS - 1) + bx, ky * (MIN_INIT_VALS - 1) + by, averageSize.x, averageSize.y);
-            Point_t rectv0(kx, ky);
-
-            switch (m_type)
-            {
-            case tracking::KalmanLinear:
-				if (m_useAcceleration)
-					CreateLinearAcceleration(rect0, rectv0);
-				else
-					CreateLinear(rect0, rectv0);
-                break;
+    case tracking::KalmanUnscented:
+        if (filterRect)
+            return std::make_unique<FilterImpl<tracking::UnscentedAcceleration, tracking::RectMeasurement>>(deltaTime, accelNoiseMag);
+        else
+            return std::make_unique<FilterImpl<tracking::UnscentedAcceleration, tracking::PointMeasurement>>(deltaTime, accelNoiseMag);
 
-            case tracking::KalmanUnscented:
-#ifdef USE_OCV_UKF
-                CreateUnscented(rect0, rectv0);
-#else
-				if (m_useAcceleration)
-					CreateLinearAcceleration(rect0, rectv0);
-				else
-					CreateLinear(rect0, rectv0);
-                std::cerr << "UnscentedKalmanFilter was disabled in CMAKE! Set KalmanLinear in constructor." << std::endl;
-#endif
-                break;
+    case tracking::KalmanAugmentedUnscented:
+        if (filterRect)
+            return std::make_unique<FilterImpl<tracking::AugmentedUnscentedAcceleration, tracking::RectMeasurement>>(deltaTime, accelNoiseMag);
+        else
+            return std::make_unique<FilterImpl<tracking::AugmentedUnscentedAcceleration, tracking::PointMeasurement>>(deltaTime, accelNoiseMag);
 
-            case tracking::KalmanAugmentedUnscented:
-#ifdef USE_OCV_UKF
-                CreateAugmentedUnscented(rect0, rectv0);
-#else
-				if (m_useAcceleration)
-					CreateLinearAcceleration(rect0, rectv0);
-				else
-					CreateLinear(rect0, rectv0);
-                std::cerr << "AugmentedUnscentedKalmanFilter was disabled in CMAKE! Set KalmanLinear in constructor." << std::endl;
-#endif
-                break;
-            }
-        }
+    case tracking::KalmanIMM:
+        if (filterRect)
+            return std::make_unique<FilterImpl<tracking::InteractingMultipleModel, tracking::RectMeasurement>>(deltaTime, accelNoiseMag);
+        else
+            return std::make_unique<FilterImpl<tracking::InteractingMultipleModel, tracking::PointMeasurement>>(deltaTime, accelNoiseMag);
     }
 
-    if (m_initialized)
+    if (useAcceleration)
     {
-        cv::Mat measurement(4, 1, Mat_t(1));
-        if (!dataCorrect)
-        {
-            measurement.at<track_t>(0) = m_lastRectResult.x;  // update using prediction
-            measurement.at<track_t>(1) = m_lastRectResult.y;
-            measurement.at<track_t>(2) = m_lastRectResult.width;
-            measurement.at<track_t>(3) = m_lastRectResult.height;
-        }
+        if (filterRect)
+            return std::make_unique<FilterImpl<tracking::ConstantAcceleration, tracking::RectMeasurement>>(deltaTime, accelNoiseMag);
         else
-        {
-            measurement.at<track_t>(0) = static_cast<track_t>(rect.x);  // update using measurements
-            measurement.at<track_t>(1) = static_cast<track_t>(rect.y);
-            measurement.at<track_t>(2) = static_cast<track_t>(rect.width);
-            measurement.at<track_t>(3) = static_cast<track_t>(rect.height);
-        }
-        // Correction
-        cv::Mat estimated;
-        switch (m_type)
-        {
-        case tracking::KalmanLinear:
-        {
-            estimated = m_linearKalman.correct(measurement);
-
-            m_lastRectResult.x = estimated.at<track_t>(0);   //update using measurements
-            m_lastRectResult.y = estimated.at<track_t>(1);
-            m_lastRectResult.width = estimated.at<track_t>(2);
-            m_lastRectResult.height = estimated.at<track_t>(3);
-
-            // Inertia correction
-			if (!m_useAcceleration)
-			{
-				track_t currDist = sqrtf(sqr(estimated.at<track_t>(0) - rect.x) + sqr(estimated.at<track_t>(1) - rect.y) + sqr(estimated.at<track_t>(2) - rect.width) + sqr(estimated.at<track_t>(3) - rect.height));
-				if (currDist > m_lastDist)
-					m_deltaTime = std::min(m_deltaTime + m_deltaStep, m_deltaTimeMax);
-				else
-					m_deltaTime = std::max(m_deltaTime - m_deltaStep, m_deltaTimeMin);
-
-				m_lastDist = currDist;
-
-				m_linearKalman.transitionMatrix.at<track_t>(0, 4) = m_deltaTime;
-				m_linearKalman.transitionMatrix.at<track_t>(1, 5) = m_deltaTime;
-				m_linearKalman.transitionMatrix.at<track_t>(2, 6) = m_deltaTime;
-				m_linearKalman.transitionMatrix.at<track_t>(3, 7) = m_deltaTime;
-			}
-            break;
-        }
-
-        case tracking::KalmanUnscented:
-        case tracking::KalmanAugmentedUnscented:
-#ifdef USE_OCV_UKF
-            estimated = m_uncsentedKalman->correct(measurement);
-
-            m_lastRectResult.x = estimated.at<track_t>(0);   //update using measurements
-            m_lastRectResult.y = estimated.at<track_t>(1);
-            m_lastRectResult.width = estimated.at<track_t>(6);
-            m_lastRectResult.height = estimated.at<track_t>(7);
-#else
-            estimated = m_linearKalman.correct(measurement);
-
-            m_lastRectResult.x = estimated.at<track_t>(0);   //update using measurements
-            m_lastRectResult.y = estimated.at<track_t>(1);
-            m_lastRectResult.width = estimated.at<track_t>(2);
-            m_lastRectResult.height = estimated.at<track_t>(3);
-            std::cerr << "UnscentedKalmanFilter was disabled in CMAKE! Set KalmanLinear in constructor." << std::endl;
-#endif
-            break;
-        }
+            return std::make_unique<FilterImpl<tracking::ConstantAcceleration, tracking::PointMeasurement>>(deltaTime, accelNoiseMag);
     }
     else
     {
-        if (dataCorrect)
-        {
-            m_lastRectResult.x = static_cast<track_t>(rect.x);
-            m_lastRectResult.y = static_cast<track_t>(rect.y);
-            m_lastRectResult.width = static_cast<track_t>(rect.width);
-            m_lastRectResult.height = static_cast<track_t>(rect.height);
-        }
+        if (filterRect)
+            return std::make_unique<FilterImpl<tracking::ConstantVelocity, tracking::RectMeasurement>>(deltaTime, accelNoiseMag);
+        else
+            return std::make_unique<FilterImpl<tracking::ConstantVelocity, tracking::PointMeasurement>>(deltaTime, accelNoiseMag);
     }
-    return cv::Rect(static_cast<int>(m_lastRectResult.x), static_cast<int>(m_lastRectResult.y), static_cast<int>(m_lastRectResult.width), static_cast<int>(m_lastRectResult.height));
 }
 
 //---------------------------------------------------------------------------
-cv::Vec<track_t, 2> TKalmanFilter::GetVelocity() const
+Point_t TKalmanFilter::GetPointPrediction()
 {
-    cv::Vec<track_t, 2> res(0, 0);
-    if (m_initialized)
-    {
-        switch (m_type)
-        {
-        case tracking::KalmanLinear:
-        {
-            if (m_linearKalman.statePre.rows > 3)
-            {
-                int indX = 2;
-                int indY = 3;
-                if (m_linearKalman.statePre.rows > 4)
-                {
-                    indX = 4;
-                    indY = 5;
-                }
-                res[0] = m_linearKalman.statePre.at<track_t>(indX);
-                res[1] = m_linearKalman.statePre.at<track_t>(indY);
-            }
-            break;
-        }
+    return m_filter->GetPointPrediction();
+}
 
-        case tracking::KalmanUnscented:
-        case tracking::KalmanAugmentedUnscented:
-#ifdef USE_OCV_UKF
-            cv::Mat state = m_uncsentedKalman->getState();
-            res[0] = state.at<track_t>(2);
-            res[1] = state.at<track_t>(3);
-#else
-            std::cerr << "UnscentedKalmanFilter was disabled in CMAKE! Set KalmanLinear in constructor." << std::endl;
-#endif
-            break;
-        }
+//---------------------------------------------------------------------------
+///
+/// \brief TKalmanFilter::PredictBatch
+/// Predict for all filters: one virtual call for every group of the neighbouring filters with the same specialization.
+/// The tracks of one CTracker have the same filter type, so it is one call per frame
+/// \param filters
+/// \param count
+///
+void TKalmanFilter::PredictBatch(TKalmanFilter* const* filters, size_t count)
+{
+    for (size_t i = 0; i < count;)
+    {
+        i += filters[i]->m_filter->PredictGroup(filters + i, count - i);
     }
-    return res;
+}
+
+//---------------------------------------------------------------------------
+Point_t TKalmanFilter::Update(Point_t pt, bool dataCorrect)
+{
+    return m_filter->Update(pt, dataCorrect);
+}
+
+//---------------------------------------------------------------------------
+cv::Rect TKalmanFilter::GetRectPrediction()
+{
+    return m_filter->GetRectPrediction();
+}
+
+//---------------------------------------------------------------------------
+cv::Rect TKalmanFilter::Update(cv::Rect rect, bool dataCorrect)
+{
+    return m_filter->Update(rect, dataCorrect);
+}
+
+//---------------------------------------------------------------------------
+cv::Vec<track_t, 2> TKalmanFilter::GetVelocity() const
+{
+    return m_filter->GetVelocity();
+}
+
+//---------------------------------------------------------------------------
+cv::Matx<track_t, 2, 2> TKalmanFilter::GetPositionCov() const
+{
+    return m_filter->GetPositionCov();
+}
+
+//---------------------------------------------------------------------------
+void TKalmanFilter::SetDeltaTime(track_t deltaTime)
+{
+    m_filter->SetDeltaTime(deltaTime);
 }
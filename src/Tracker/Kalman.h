@@ -5,42 +5,151 @@
 
 #include <opencv2/opencv.hpp>
 
-#ifdef USE_OCV_UKF
-#include <opencv2/tracking.hpp>
-#include <opencv2/tracking/kalman_filters.hpp>
-#endif
+#include "LinearKalman.h"
+#include "UnscentedKalman.h"
+#include "IMMKalman.h"
 
+namespace tracking
+{
 ///
-/// \brief The TKalmanFilter class
-/// http://www.morethantechnical.com/2011/06/17/simple-kalman-filter-for-tracking-using-opencv-2-2-w-code/
+/// \brief The ConstantVelocity struct
+/// Motion model x(t) = x0 + v0 * t
 ///
-class TKalmanFilter
+struct ConstantVelocity
+{
+    static constexpr int ORDER = 2;
+    static constexpr bool LINEAR = true;
+};
+
+///
+/// \brief The ConstantAcceleration struct
+/// Motion model x(t) = x0 + v0 * t + a * t^2 / 2
+/// https://www.mathworks.com/help/driving/ug/linear-kalman-filters.html
+///
+struct ConstantAcceleration
+{
+    static constexpr int ORDER = 3;
+    static constexpr bool LINEAR = true;
+};
+
+///
+/// \brief The UnscentedAcceleration struct
+/// Constant acceleration model with the unscented Kalman filter
+///
+struct UnscentedAcceleration
+{
+    static constexpr bool LINEAR = false;
+    static constexpr bool AUGMENTED = false;
+};
+
+///
+/// \brief The AugmentedUnscentedAcceleration struct
+/// Constant acceleration model with the augmented unscented Kalman filter
+///
+struct AugmentedUnscentedAcceleration
+{
+    static constexpr bool LINEAR = false;
+    static constexpr bool AUGMENTED = true;
+};
+
+///
+/// \brief The InteractingMultipleModel struct
+/// Mixing of the constant velocity and constant acceleration linear models (IMM)
+///
+struct InteractingMultipleModel
+{
+    static constexpr bool LINEAR = false;
+};
+
+///
+/// \brief The PointMeasurement struct
+/// Measured values: x, y
+///
+struct PointMeasurement
+{
+    static constexpr int MEAS_SIZE = 2;
+};
+
+///
+/// \brief The RectMeasurement struct
+/// Measured values: x, y, width, height
+///
+struct RectMeasurement
+{
+    static constexpr int MEAS_SIZE = 4;
+};
+}
+
+///
+/// \brief The KalmanEngine struct
+/// Filter implementation for the motion model and measurement
+///
+template<class MODEL, class MEASUREMENT, bool LINEAR = MODEL::LINEAR>
+struct KalmanEngine
+{
+    typedef TLinearKalman<MODEL::ORDER * MEASUREMENT::MEAS_SIZE, MEASUREMENT::MEAS_SIZE> type;
+};
+
+template<class MODEL, class MEASUREMENT>
+struct KalmanEngine<MODEL, MEASUREMENT, false>
+{
+    typedef TUnscentedKalman<UkfAcceleratedModel<MEASUREMENT::MEAS_SIZE>, MODEL::AUGMENTED> type;
+};
+
+template<class MEASUREMENT>
+struct KalmanEngine<tracking::InteractingMultipleModel, MEASUREMENT, false>
+{
+    typedef TIMMKalman<MEASUREMENT::MEAS_SIZE> type;
+};
+
+///
+/// \brief The TKalmanFilterT class
+/// Kalman filter specialized at compile time by the motion model and the measurement type: no branching on the filter type inside
+///
+template<class MODEL, class MEASUREMENT>
+class TKalmanFilterT
 {
 public:
-    TKalmanFilter(tracking::KalmanType type, bool useAcceleration, track_t deltaTime, track_t accelNoiseMag);
-    ~TKalmanFilter() = default;
+    static constexpr int MEAS_SIZE = MEASUREMENT::MEAS_SIZE;
+    typedef cv::Matx<track_t, MEAS_SIZE, 1> meas_t;
 
-    Point_t GetPointPrediction();
-    Point_t Update(Point_t pt, bool dataCorrect);
+    TKalmanFilterT(track_t deltaTime, track_t accelNoiseMag);
 
-    cv::Rect GetRectPrediction();
-    cv::Rect Update(cv::Rect rect, bool dataCorrect);
+    meas_t Predict();
+    meas_t Update(const meas_t& measurement, bool dataCorrect);
 
-	cv::Vec<track_t, 2> GetVelocity() const;
+    cv::Vec<track_t, 2> GetVelocity() const;
+    cv::Matx<track_t, 2, 2> GetPositionCov() const;
+
+    void SetDeltaTime(track_t deltaTime);
+
+    ///
+    /// \brief LastResult
+    /// \return Last prediction or estimation
+    ///
+    const meas_t& LastResult() const
+    {
+        return m_lastResult;
+    }
+
+    ///
+    /// \brief MakeModel
+    /// Transition and process noise matrices of the linear model, the IMM filter mixes them
+    /// \param deltaTime
+    /// \param accelNoiseMag
+    /// \param transition - STATE x STATE values
+    /// \param processNoise - STATE x STATE values
+    ///
+    static void MakeModel(track_t deltaTime, track_t accelNoiseMag, track_t* transition, track_t* processNoise);
 
 private:
-    cv::KalmanFilter m_linearKalman;
-#ifdef USE_OCV_UKF
-    cv::Ptr<cv::tracking::UnscentedKalmanFilter> m_uncsentedKalman;
-#endif
+    typedef typename KalmanEngine<MODEL, MEASUREMENT>::type engine_t;
+    engine_t m_kalman;
 
     static constexpr size_t MIN_INIT_VALS = 4;
-    std::vector<Point_t> m_initialPoints;
-    std::vector<cv::Rect> m_initialRects;
+    std::vector<meas_t> m_initialValues;
 
-    cv::Rect_<track_t> m_lastRectResult;
-    cv::Rect_<track_t> m_lastRect;
-    Point_t m_lastPointResult;
+    meas_t m_lastResult;
     track_t m_accelNoiseMag = 0.5f;
     track_t m_deltaTime = 0.2f;
     track_t m_deltaTimeMin = 0.2f;
@@ -48,25 +157,56 @@ private:
     track_t m_lastDist = 0;
     track_t m_deltaStep = 0;
     static constexpr int m_deltaStepsCount = 20;
-    tracking::KalmanType m_type = tracking::KalmanLinear;
-    bool m_useAcceleration = false; // If set true then will be used motion model x(t) = x0 + v0 * t + a * t^2 / 2
     bool m_initialized = false;
 
-	// Constant velocity model
-    void CreateLinear(Point_t xy0, Point_t xyv0);
-    void CreateLinear(cv::Rect_<track_t> rect0, Point_t rectv0);
-	
-	// Constant acceleration model
-	// https://www.mathworks.com/help/driving/ug/linear-kalman-filters.html
-	void CreateLinearAcceleration(Point_t xy0, Point_t xyv0);
-	void CreateLinearAcceleration(cv::Rect_<track_t> rect0, Point_t rectv0);
-
-#ifdef USE_OCV_UKF
-    void CreateUnscented(Point_t xy0, Point_t xyv0);
-    void CreateUnscented(cv::Rect_<track_t> rect0, Point_t rectv0);
-    void CreateAugmentedUnscented(Point_t xy0, Point_t xyv0);
-    void CreateAugmentedUnscented(cv::Rect_<track_t> rect0, Point_t rectv0);
-#endif
+    void Create(const meas_t& value0, cv::Vec<track_t, 2> velocity0);
+    void ApplyModel(const typename engine_t::state_t* state0);
+
+    template<int N>
+    static meas_t Measured(const cv::Matx<track_t, N, 1>& state)
+    {
+        meas_t res;
+        for (int i = 0; i < MEAS_SIZE; ++i)
+        {
+            res(i) = state(i);
+        }
+        return res;
+    }
+};
+
+///
+/// \brief The TKalmanFilter class
+/// http://www.morethantechnical.com/2011/06/17/simple-kalman-filter-for-tracking-using-opencv-2-2-w-code/
+/// The filter specialization is selected once in constructor and is kept behind the one virtual interface.
+/// Prediction of all tracks is one virtual call per group of the filters with the same specialization (PredictBatch),
+/// correction and the other methods are one virtual call per track
+///
+class TKalmanFilter
+{
+public:
+    TKalmanFilter(tracking::KalmanType type, bool useAcceleration, bool filterRect, track_t deltaTime, track_t accelNoiseMag);
+    ~TKalmanFilter();
+
+    Point_t GetPointPrediction();
+    Point_t Update(Point_t pt, bool dataCorrect);
+
+    static void PredictBatch(TKalmanFilter* const* filters, size_t count);
+
+    cv::Rect GetRectPrediction();
+    cv::Rect Update(cv::Rect rect, bool dataCorrect);
+
+	cv::Vec<track_t, 2> GetVelocity() const;
+    cv::Matx<track_t, 2, 2> GetPositionCov() const;
+
+    void SetDeltaTime(track_t deltaTime);
+
+private:
+    // TKalmanFilterT specializations behind the one virtual interface, they are defined in Kalman.cpp
+    class IFilter;
+    template<class MODEL, class MEASUREMENT> class FilterImpl;
+    std::unique_ptr<IFilter> m_filter;
+
+    static std::unique_ptr<IFilter> CreateFilter(tracking::KalmanType type, bool useAcceleration, bool filterRect, track_t deltaTime, track_t accelNoiseMag);
 };
 
 //---------------------------------------------------------------------------
@@ -0,0 +1,140 @@
+#include "LAPJV.h"
+
+///
+/// \brief LAPJVSolver::Solve
+/// \param costMatrix - column-major matrix: rows are tracks, columns are regions
+/// \param nOfRows
+/// \param nOfColumns
+/// \param assignment - region index for every row or -1
+/// \return Total cost of the assigned pairs
+///
+track_t LAPJVSolver::Solve(const distMatrix_t& costMatrix, size_t nOfRows, size_t nOfColumns, assignments_t& assignment)
+{
+    assignment.assign(nOfRows, -1);
+    if (!nOfRows || !nOfColumns)
+        return 0;
+
+    // The smaller side is always augmented, so every row will be assigned
+    const bool transposed = nOfRows > nOfColumns;
+    m_rows = transposed ? nOfColumns : nOfRows;
+    m_cols = transposed ? nOfRows : nOfColumns;
+
+    m_costs.resize(m_rows * m_cols);
+    if (transposed)
+    {
+        // Regions are rows: costMatrix is already row-major for them
+        std::copy(costMatrix.begin(), costMatrix.begin() + m_rows * m_cols, m_costs.begin());
+    }
+    else
+    {
+        for (size_t i = 0; i < m_rows; ++i)
+        {
+            track_t* rowCosts = &m_costs[i * m_cols];
+            for (size_t j = 0; j < m_cols; ++j)
+            {
+                rowCosts[j] = costMatrix[i + j * nOfRows];
+            }
+        }
+    }
+
+    m_colsPotential.assign(m_cols, 0);
+    m_colsRow.assign(m_cols, -1);
+    m_rowsCol.assign(m_rows, -1);
+    m_dist.resize(m_cols);
+    m_pred.resize(m_cols);
+    m_scanned.resize(m_cols);
+
+    for (size_t row = 0; row < m_rows; ++row)
+    {
+        Augment(static_cast<int>(row));
+    }
+
+    track_t cost = 0;
+    for (size_t row = 0; row < m_rows; ++row)
+    {
+        const int col = m_rowsCol[row];
+        cost += m_costs[row * m_cols + col];
+        if (transposed)
+            assignment[col] = static_cast<int>(row);
+        else
+            assignment[row] = col;
+    }
+    return cost;
+}
+
+///
+/// \brief LAPJVSolver::Augment
+/// Dijkstra search of the shortest augmenting path from the free row with linear scan of the columns
+/// \param freeRow
+///
+void LAPJVSolver::Augment(int freeRow)
+{
+    const track_t* rowCosts = &m_costs[freeRow * m_cols];
+    for (size_t j = 0; j < m_cols; ++j)
+    {
+        m_dist[j] = rowCosts[j] - m_colsPotential[j];
+        m_pred[j] = freeRow;
+        m_scanned[j] = 0;
+    }
+    m_scannedCols.clear();
+
+    int sink = -1;
+    for (;;)
+    {
+        // Closest not scanned column
+        int minCol = -1;
+        track_t minDist = INF_DIST;
+        for (size_t j = 0; j < m_cols; ++j)
+        {
+            if (!m_scanned[j] && (minCol < 0 || m_dist[j] < minDist))
+            {
+                minDist = m_dist[j];
+                minCol = static_cast<int>(j);
+            }
+        }
+
+        if (m_colsRow[minCol] < 0)
+        {
+            sink = minCol;
+            break;
+        }
+
+        m_scanned[minCol] = 1;
+        m_scannedCols.push_back(minCol);
+
+        // Continue the path through the row assigned to this column
+        const int row = m_colsRow[minCol];
+        rowCosts = &m_costs[row * m_cols];
+        const track_t rowOffset = minDist - (rowCosts[minCol] - m_colsPotential[minCol]);
+        for (size_t j = 0; j < m_cols; ++j)
+        {
+            if (m_scanned[j])
+                continue;
+            const track_t dist = rowOffset + rowCosts[j] - m_colsPotential[j];
+            if (dist < m_dist[j])
+            {
+                m_dist[j] = dist;
+                m_pred[j] = row;
+            }
+        }
+    }
+
+    // Update potentials of the scanned columns
+    const track_t sinkDist = m_dist[sink];
+    for (int col : m_scannedCols)
+    {
+        m_colsPotential[col] += m_dist[col] - sinkDist;
+    }
+
+    // Augment along the path
+    for (int col = sink;;)
+    {
+        const int row = m_pred[col];
+        const int prevCol = m_rowsCol[row];
+        m_colsRow[col] = row;
+        m_rowsCol[row] = col;
+        if (row == freeRow)
+            break;
+        col = prevCol;
+    }
+}
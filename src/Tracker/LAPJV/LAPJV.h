@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include <limits>
+#include "defines.h"
+
+///
+/// \brief The LAPJVSolver class
+/// Dense shortest augmenting path (Jonker-Volgenant) assignment for the rectangular matrices.
+/// All buffers are kept between calls
+///
+class LAPJVSolver
+{
+public:
+    LAPJVSolver() = default;
+    ~LAPJVSolver() = default;
+
+    track_t Solve(const distMatrix_t& costMatrix, size_t nOfRows, size_t nOfColumns, assignments_t& assignment);
+
+private:
+    static constexpr track_t INF_DIST = std::numeric_limits<track_t>::max();
+
+    // Row-major copy of the cost matrix with rows count <= columns count
+    std::vector<track_t> m_costs;
+    size_t m_rows = 0;
+    size_t m_cols = 0;
+
+    std::vector<track_t> m_colsPotential;
+    std::vector<int> m_colsRow;
+    std::vector<int> m_rowsCol;
+
+    // Dijkstra buffers
+    std::vector<track_t> m_dist;
+    std::vector<int> m_pred;
+    std::vector<char> m_scanned;
+    std::vector<int> m_scannedCols;
+
+    void Augment(int freeRow);
+};
@@ -0,0 +1,406 @@
+#pragma once
+#include <limits>
+#include <utility>
+#include "defines.h"
+
+///
+/// \brief DotProductN
+/// Dot product with 4 independent accumulators, the compiler vectorizes it without fast math
+/// \param a
+/// \param b
+/// \param count
+/// \return
+///
+inline track_t DotProductN(const track_t* a, const track_t* b, int count)
+{
+    track_t s0 = 0;
+    track_t s1 = 0;
+    track_t s2 = 0;
+    track_t s3 = 0;
+    int k = 0;
+    for (; k + 3 < count; k += 4)
+    {
+        s0 += a[k] * b[k];
+        s1 += a[k + 1] * b[k + 1];
+        s2 += a[k + 2] * b[k + 2];
+        s3 += a[k + 3] * b[k + 3];
+    }
+    for (; k < count; ++k)
+    {
+        s0 += a[k] * b[k];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+///
+/// \brief CholeskyDecomp
+/// A = L * L^T for the symmetric positive definite matrix A, L is written to the lower triangle of A and the upper triangle is zeroed
+/// \param A
+/// \return false if A is not positive definite
+///
+template<int N>
+bool CholeskyDecomp(cv::Matx<track_t, N, N>& A)
+{
+    for (int i = 0; i < N; ++i)
+    {
+        track_t* rowI = &A.val[i * N];
+        for (int j = 0; j <= i; ++j)
+        {
+            const track_t* rowJ = &A.val[j * N];
+            const track_t s = rowI[j] - DotProductN(rowI, rowJ, j);
+            if (i == j)
+            {
+                if (s <= 0)
+                    return false;
+                rowI[i] = std::sqrt(s);
+            }
+            else
+            {
+                rowI[j] = s / rowJ[j];
+            }
+        }
+        for (int j = i + 1; j < N; ++j)
+        {
+            rowI[j] = 0;
+        }
+    }
+    return true;
+}
+
+///
+/// \brief CholeskySolve
+/// Solve A * X = B for the small symmetric positive definite matrix A, X is written to B
+/// \param A
+/// \param B
+/// \return false if A is not positive definite
+///
+template<int N, int K>
+bool CholeskySolve(cv::Matx<track_t, N, N> A, cv::Matx<track_t, N, K>& B)
+{
+    // A = L * L^T, L is stored in the lower triangle of A, the diagonal is inverted
+    for (int i = 0; i < N; ++i)
+    {
+        for (int j = 0; j <= i; ++j)
+        {
+            track_t s = A(i, j);
+            for (int k = 0; k < j; ++k)
+            {
+                s -= A(i, k) * A(j, k);
+            }
+            if (i == j)
+            {
+                if (s <= 0)
+                    return false;
+                A(i, i) = 1 / std::sqrt(s);
+            }
+            else
+            {
+                A(i, j) = s * A(j, j);
+            }
+        }
+    }
+    for (int c = 0; c < K; ++c)
+    {
+        // L * y = b
+        for (int i = 0; i < N; ++i)
+        {
+            track_t s = B(i, c);
+            for (int k = 0; k < i; ++k)
+            {
+                s -= A(i, k) * B(k, c);
+            }
+            B(i, c) = s * A(i, i);
+        }
+        // L^T * x = y
+        for (int i = N - 1; i >= 0; --i)
+        {
+            track_t s = B(i, c);
+            for (int k = i + 1; k < N; ++k)
+            {
+                s -= A(k, i) * B(k, c);
+            }
+            B(i, c) = s * A(i, i);
+        }
+    }
+    return true;
+}
+
+///
+/// \brief LUSolve
+/// Solve A * X = B for the small square matrix A with the partial pivoting, X is written to B
+/// \param A
+/// \param B
+/// \param det - determinant of A, optional
+/// \return false if A is singular
+///
+template<int N, int K>
+bool LUSolve(cv::Matx<track_t, N, N> A, cv::Matx<track_t, N, K>& B, track_t* det = nullptr)
+{
+    track_t detA = 1;
+    for (int c = 0; c < N; ++c)
+    {
+        int pivot = c;
+        for (int i = c + 1; i < N; ++i)
+        {
+            if (std::abs(A(i, c)) > std::abs(A(pivot, c)))
+                pivot = i;
+        }
+        if (std::abs(A(pivot, c)) < std::numeric_limits<track_t>::min())
+            return false;
+        if (pivot != c)
+        {
+            detA = -detA;
+            for (int j = 0; j < N; ++j)
+            {
+                std::swap(A(c, j), A(pivot, j));
+            }
+            for (int j = 0; j < K; ++j)
+            {
+                std::swap(B(c, j), B(pivot, j));
+            }
+        }
+        detA *= A(c, c);
+        const track_t invPivot = 1 / A(c, c);
+        for (int i = c + 1; i < N; ++i)
+        {
+            const track_t f = A(i, c) * invPivot;
+            for (int j = c + 1; j < N; ++j)
+            {
+                A(i, j) -= f * A(c, j);
+            }
+            for (int j = 0; j < K; ++j)
+            {
+                B(i, j) -= f * B(c, j);
+            }
+        }
+    }
+    for (int i = N - 1; i >= 0; --i)
+    {
+        const track_t invDiag = 1 / A(i, i);
+        for (int j = 0; j < K; ++j)
+        {
+            track_t s = B(i, j);
+            for (int k = i + 1; k < N; ++k)
+            {
+                s -= A(i, k) * B(k, j);
+            }
+            B(i, j) = s * invDiag;
+        }
+    }
+    if (det)
+        *det = detA;
+    return true;
+}
+
+///
+/// \brief The TLinearKalman class
+/// Linear Kalman filter with the compile time state and measurement sizes: all matrices are cv::Matx without heap allocations.
+/// The state is (measured values, their velocities, ...), so the measurement matrix is always [I 0] and isn't stored.
+/// Every track owns its filter and there is no batched SoA predict/correct over the filters states: prediction of 500 CA rect filters
+/// gathered by 8 to the structure of arrays wasn't faster, gather and scatter alone took 2/3 of the per-filter prediction time.
+/// CTracker predicts all tracks with one virtual call per group of filters (TKalmanFilter::PredictBatch), see tests/KalmanBenchmark
+///
+template<int STATE, int MEAS>
+class TLinearKalman
+{
+public:
+    static_assert(MEAS <= STATE, "Measurement size must be less or equal to the state size");
+
+    typedef cv::Matx<track_t, STATE, 1> state_t;
+    typedef cv::Matx<track_t, MEAS, 1> meas_t;
+    typedef cv::Matx<track_t, STATE, STATE> cov_t;
+
+    static constexpr int STATE_SIZE = STATE;
+    static constexpr int MEAS_SIZE = MEAS;
+
+    ///
+    /// \brief Init
+    /// \param transition - STATE x STATE values
+    /// \param processNoise - STATE x STATE values
+    /// \param state0 - STATE values
+    /// \param measurementNoise
+    /// \param errorCov
+    ///
+    void Init(const track_t* transition, const track_t* processNoise, const track_t* state0, track_t measurementNoise, track_t errorCov)
+    {
+        m_transition = cov_t(transition);
+        m_processNoise = cov_t(processNoise);
+        m_statePre = state_t(state0);
+        m_statePost = m_statePre;
+        m_measurementNoise = cv::Matx<track_t, MEAS, MEAS>::eye() * measurementNoise;
+        m_errorCovPre = cov_t::eye() * errorCov;
+        m_errorCovPost = m_errorCovPre;
+    }
+
+    ///
+    /// \brief SetModel
+    /// Change the motion model and keep the current state and covariance
+    /// \param transition - STATE x STATE values
+    /// \param processNoise - STATE x STATE values
+    ///
+    void SetModel(const track_t* transition, const track_t* processNoise)
+    {
+        m_transition = cov_t(transition);
+        m_processNoise = cov_t(processNoise);
+    }
+
+    ///
+    /// \brief Predict
+    /// \return
+    ///
+    const state_t& Predict()
+    {
+        m_statePre = m_transition * m_statePost;
+        m_errorCovPre = m_transition * m_errorCovPost * m_transition.t() + m_processNoise;
+
+        m_statePost = m_statePre;
+        m_errorCovPost = m_errorCovPre;
+        return m_statePre;
+    }
+
+    ///
+    /// \brief Correct
+    /// \param measurement
+    /// \return
+    ///
+    const state_t& Correct(const meas_t& measurement)
+    {
+        // H * P and H * P * H^T + R are only the first MEAS rows of P, the last column of rhs is the residual
+        cv::Matx<track_t, MEAS, STATE + 1> rhs;
+        cv::Matx<track_t, MEAS, MEAS> innovCov;
+        meas_t residual;
+        for (int i = 0; i < MEAS; ++i)
+        {
+            for (int j = 0; j < STATE; ++j)
+            {
+                rhs(i, j) = m_errorCovPre(i, j);
+            }
+            for (int j = 0; j < MEAS; ++j)
+            {
+                innovCov(i, j) = m_errorCovPre(i, j) + m_measurementNoise(i, j);
+            }
+            residual(i) = measurement(i) - m_statePre(i);
+            rhs(i, STATE) = residual(i);
+        }
+
+        // One factorization of S for K^T = S^-1 * H * P and S^-1 * residual
+        track_t det = 0;
+        if (!LUSolve(innovCov, rhs, &det) || det <= 0)
+        {
+            m_statePost = m_statePre;
+            m_errorCovPost = m_errorCovPre;
+            m_logLikelihood = -std::numeric_limits<track_t>::max();
+            return m_statePost;
+        }
+        track_t mahalanobis = 0;
+        for (int i = 0; i < MEAS; ++i)
+        {
+            mahalanobis += residual(i) * rhs(i, STATE);
+        }
+        // Gaussian log likelihood of the measurement without the constant term
+        m_logLikelihood = -(mahalanobis + std::log(det)) / 2;
+
+        for (int i = 0; i < STATE; ++i)
+        {
+            track_t s = m_statePre(i);
+            for (int k = 0; k < MEAS; ++k)
+            {
+                s += rhs(k, i) * residual(k);
+            }
+            m_statePost(i) = s;
+        }
+        for (int i = 0; i < STATE; ++i)
+        {
+            for (int j = 0; j < STATE; ++j)
+            {
+                track_t s = m_errorCovPre(i, j);
+                for (int k = 0; k < MEAS; ++k)
+                {
+                    s -= rhs(k, i) * m_errorCovPre(k, j);
+                }
+                m_errorCovPost(i, j) = s;
+            }
+        }
+        return m_statePost;
+    }
+
+    ///
+    /// \brief SetStatePost
+    /// Replace the filter estimation, for example, with mixed estimation in the IMM filter
+    /// \param state
+    /// \param errorCov
+    ///
+    void SetStatePost(const state_t& state, const cov_t& errorCov)
+    {
+        m_statePost = state;
+        m_errorCovPost = errorCov;
+    }
+
+    ///
+    /// \brief ErrorCovPost
+    /// \return
+    ///
+    const cov_t& ErrorCovPost() const
+    {
+        return m_errorCovPost;
+    }
+
+    ///
+    /// \brief LogLikelihood
+    /// \return Log likelihood of the last measurement (without the constant term)
+    ///
+    track_t LogLikelihood() const
+    {
+        return m_logLikelihood;
+    }
+
+    ///
+    /// \brief SetVelocityTransition
+    /// Time step for the measured values from their velocities
+    /// \param dt
+    ///
+    void SetVelocityTransition(track_t dt)
+    {
+        for (int i = 0; i < MEAS; ++i)
+        {
+            m_transition(i, i + MEAS) = dt;
+        }
+    }
+
+    ///
+    /// \brief GetVelocity
+    /// \return Velocity of the first two measured values
+    ///
+    cv::Vec<track_t, 2> GetVelocity() const
+    {
+        return cv::Vec<track_t, 2>(m_statePre(MEAS), m_statePre(MEAS + 1));
+    }
+
+    ///
+    /// \brief PositionCov
+    /// \return Covariance of the first two measured values after the last prediction or correction
+    ///
+    cv::Matx<track_t, 2, 2> PositionCov() const
+    {
+        cv::Matx<track_t, 2, 2> cov;
+        for (int i = 0; i < 2; ++i)
+        {
+            for (int j = 0; j < 2; ++j)
+            {
+                cov(i, j) = m_errorCovPost(i, j);
+            }
+        }
+        return cov;
+    }
+
+    state_t m_statePre;
+    state_t m_statePost;
+
+private:
+    cov_t m_transition;
+    cov_t m_processNoise;
+    cov_t m_errorCovPre;
+    cov_t m_errorCovPost;
+    cv::Matx<track_t, MEAS, MEAS> m_measurementNoise;
+    track_t m_logLikelihood = 0;
+};
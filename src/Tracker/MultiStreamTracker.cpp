@@ -0,0 +1,209 @@
+#include <cassert>
+#include "MultiStreamTracker.h"
+
+///
+/// \brief MultiStreamTracker::MultiStreamTracker
+/// \param threads - pool size, 0 - hardware concurrency
+/// \param onFrameTracked - can be empty
+///
+MultiStreamTracker::MultiStreamTracker(size_t threads, callback_t onFrameTracked)
+    :
+      m_onFrameTracked(onFrameTracked),
+      m_pool(std::make_shared<ThreadPool>(threads)),
+      m_executor(std::make_shared<ThreadPoolExecutor>(m_pool))
+{
+}
+
+///
+/// \brief MultiStreamTracker::~MultiStreamTracker
+///
+MultiStreamTracker::~MultiStreamTracker()
+{
+    Wait();
+}
+
+///
+/// \brief MultiStreamTracker::AddStream
+/// Streams are added before the first Update
+/// \param settings - m_executor is replaced by the service pool executor
+/// \return Stream index
+///
+size_t MultiStreamTracker::AddStream(TrackerSettings settings)
+{
+    settings.m_executor = m_executor;
+
+    m_streams.emplace_back(std::make_unique<Stream>());
+    m_streams.back()->m_tracker = std::make_unique<CTracker>(settings);
+    return m_streams.size() - 1;
+}
+
+///
+/// \brief MultiStreamTracker::StreamsCount
+/// \return
+///
+size_t MultiStreamTracker::StreamsCount() const
+{
+    return m_streams.size();
+}
+
+///
+/// \brief MultiStreamTracker::Update
+/// Frame is added to the stream queue and processed asynchronously
+/// \param streamInd
+/// \param regions
+/// \param currFrame - it is copied, so the caller can reuse the buffer for the next frame
+/// \param fps
+/// \param timestamp - frame time in seconds
+///
+void MultiStreamTracker::Update(size_t streamInd, const regions_t& regions, const cv::UMat& currFrame, float fps, double timestamp)
+{
+    cv::UMat frame;
+    currFrame.copyTo(frame);
+    Update(streamInd, regions, std::move(frame), fps, timestamp);
+}
+
+///
+/// \brief MultiStreamTracker::Update
+/// Frame is added to the stream queue without copying and processed asynchronously
+/// \param streamInd
+/// \param regions
+/// \param currFrame - the queue takes the ownership: the frame data must not be shared with the caller buffers (for example, with Mat::getUMat)
+/// \param fps
+/// \param timestamp - frame time in seconds
+///
+void MultiStreamTracker::Update(size_t streamInd, const regions_t& regions, cv::UMat&& currFrame, float fps, double timestamp)
+{
+    assert(streamInd < m_streams.size());
+    Stream& stream = *m_streams[streamInd];
+
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        ++m_framesInProgress;
+    }
+
+    bool startTask = false;
+    {
+        std::lock_guard<std::mutex> lock(stream.m_mutex);
+        StreamFrame frame;
+        frame.m_regions = regions;
+        frame.m_frame = std::move(currFrame);
+        frame.m_fps = fps;
+        frame.m_timestamp = timestamp;
+        frame.m_submitTime = steady_clock_t::now();
+        stream.m_frames.emplace_back(std::move(frame));
+
+        // Only one task for the stream: frames are processed in order
+        if (!stream.m_busy)
+        {
+            stream.m_busy = true;
+            startTask = true;
+        }
+    }
+    if (startTask)
+        m_pool->Submit([this, streamInd]() { ProcessStream(streamInd); });
+}
+
+///
+/// \brief MultiStreamTracker::Wait
+/// Wait the processing end of all submitted frames
+///
+void MultiStreamTracker::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_waitMutex);
+    m_waitCond.wait(lock, [this]() { return m_framesInProgress == 0; });
+}
+
+///
+/// \brief MultiStreamTracker::GetStatistic
+/// \param streamInd
+/// \return
+///
+StreamStatistic MultiStreamTracker::GetStatistic(size_t streamInd) const
+{
+    assert(streamInd < m_streams.size());
+    const Stream& stream = *m_streams[streamInd];
+    std::lock_guard<std::mutex> lock(stream.m_mutex);
+    return stream.m_statistic;
+}
+
+///
+/// \brief MultiStreamTracker::ProcessStream
+/// Pool task: process one frame and resubmit itself if the stream has more frames
+/// \param streamInd
+///
+void MultiStreamTracker::ProcessStream(size_t streamInd)
+{
+    // The frame is finished on any exit, so the stream isn't blocked and Wait returns after the exception
+    struct FrameGuard
+    {
+        MultiStreamTracker* m_owner;
+        size_t m_streamInd;
+        ~FrameGuard()
+        {
+            m_owner->FinishFrame(m_streamInd);
+        }
+    } frameGuard { this, streamInd };
+
+    Stream& stream = *m_streams[streamInd];
+
+    StreamFrame frame;
+    {
+        std::lock_guard<std::mutex> lock(stream.m_mutex);
+        frame = std::move(stream.m_frames.front());
+        stream.m_frames.pop_front();
+    }
+
+    // An exception must not leave the pool task: it would terminate the worker thread
+    try
+    {
+        auto startTime = steady_clock_t::now();
+        stream.m_tracker->Update(frame.m_regions, frame.m_frame, frame.m_fps, frame.m_timestamp);
+        auto endTime = steady_clock_t::now();
+
+        StreamStatistic statistic;
+        {
+            std::lock_guard<std::mutex> lock(stream.m_mutex);
+            StreamStatistic& stat = stream.m_statistic;
+            ++stat.m_frames;
+            stat.m_lastLatency = std::chrono::duration<double, std::milli>(endTime - frame.m_submitTime).count();
+            stat.m_lastProcessing = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+            stat.m_sumLatency += stat.m_lastLatency;
+            stat.m_maxLatency = std::max(stat.m_maxLatency, stat.m_lastLatency);
+            statistic = stat;
+        }
+
+        // The next frame of the stream isn't started before the callback end, so the tracker isn't changed inside it
+        if (m_onFrameTracked)
+            m_onFrameTracked(streamInd, *stream.m_tracker, statistic);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(stream.m_mutex);
+        ++stream.m_statistic.m_failedFrames;
+    }
+}
+
+///
+/// \brief MultiStreamTracker::FinishFrame
+/// Resubmit the stream task if the stream has more frames or release the stream, then decrease the frames in progress counter
+/// \param streamInd
+///
+void MultiStreamTracker::FinishFrame(size_t streamInd)
+{
+    Stream& stream = *m_streams[streamInd];
+
+    bool hasFrames = false;
+    {
+        std::lock_guard<std::mutex> lock(stream.m_mutex);
+        hasFrames = !stream.m_frames.empty();
+        if (!hasFrames)
+            stream.m_busy = false;
+    }
+    if (hasFrames)
+        m_pool->Submit([this, streamInd]() { ProcessStream(streamInd); });
+
+    // Notify under the lock: Wait in the destructor can't return before it
+    std::lock_guard<std::mutex> lock(m_waitMutex);
+    --m_framesInProgress;
+    m_waitCond.notify_all();
+}
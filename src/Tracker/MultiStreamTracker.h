@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+
+#include "Ctracker.h"
+#include "ParallelExecutor.h"
+
+///
+/// \brief The StreamStatistic struct
+/// Latency is the time from MultiStreamTracker::Update call to the end of the frame processing, milliseconds
+///
+struct StreamStatistic
+{
+    size_t m_frames = 0;
+    double m_lastLatency = 0;
+    double m_maxLatency = 0;
+    double m_sumLatency = 0;
+    double m_lastProcessing = 0; // CTracker::Update duration without waiting in the queue
+    size_t m_failedFrames = 0;   // CTracker::Update or the callback threw an exception
+
+    ///
+    /// \brief AvgLatency
+    /// \return
+    ///
+    double AvgLatency() const
+    {
+        return m_frames ? (m_sumLatency / m_frames) : 0.;
+    }
+};
+
+///
+/// \brief The MultiStreamTracker class
+/// Tracking of the independent streams (cameras) in one thread pool: frames of the different streams are processed in parallel,
+/// frames of one stream - in the order of the Update calls. The tracks loops of all trackers are tasks of the same pool, so OpenMP isn't used
+///
+class MultiStreamTracker
+{
+public:
+    ///
+    /// \brief Stream result callback, it is called from the pool thread after every frame: tracker is available only inside
+    ///
+    typedef std::function<void(size_t streamInd, const CTracker& tracker, const StreamStatistic& statistic)> callback_t;
+
+    MultiStreamTracker(size_t threads, callback_t onFrameTracked);
+    MultiStreamTracker(const MultiStreamTracker&) = delete;
+    MultiStreamTracker& operator=(const MultiStreamTracker&) = delete;
+    ~MultiStreamTracker();
+
+    size_t AddStream(TrackerSettings settings);
+    size_t StreamsCount() const;
+
+    void Update(size_t streamInd, const regions_t& regions, const cv::UMat& currFrame, float fps, double timestamp);
+    void Update(size_t streamInd, const regions_t& regions, cv::UMat&& currFrame, float fps, double timestamp);
+    void Wait();
+
+    StreamStatistic GetStatistic(size_t streamInd) const;
+
+private:
+    typedef std::chrono::steady_clock steady_clock_t;
+
+    ///
+    /// \brief The StreamFrame struct
+    ///
+    struct StreamFrame
+    {
+        regions_t m_regions;
+        cv::UMat m_frame;   // Owned by the queue: the caller can reuse its buffer after Update
+        float m_fps = 0;
+        double m_timestamp = 0;
+        steady_clock_t::time_point m_submitTime;
+    };
+
+    ///
+    /// \brief The Stream struct
+    ///
+    struct Stream
+    {
+        std::unique_ptr<CTracker> m_tracker;
+        std::deque<StreamFrame> m_frames;
+        bool m_busy = false;        // The stream task is in the pool
+        StreamStatistic m_statistic;
+        mutable std::mutex m_mutex;
+    };
+    std::vector<std::unique_ptr<Stream>> m_streams;
+
+    callback_t m_onFrameTracked;
+
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitCond;
+    size_t m_framesInProgress = 0;
+
+    std::shared_ptr<ThreadPool> m_pool;
+    std::shared_ptr<ParallelExecutor> m_executor; // Pool executor for all streams trackers
+
+    void ProcessStream(size_t streamInd);
+    void FinishFrame(size_t streamInd);
+};
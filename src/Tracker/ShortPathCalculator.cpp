@@ -1,9 +1,27 @@
 #include "ShortPathCalculator.h"
 
-#include <GTL/GTL.h>
-#include "mygraph.h"
-#include "mwbmatching.h"
-#include "tokenise.h"
+///
+/// \brief ShortPathCalculator::Solve
+/// Solve for the dense matrix: pairs that are absent in the sparse matrix get maxCost
+/// \param costMatrix
+/// \param assignment
+/// \param maxCost
+///
+void ShortPathCalculator::Solve(const SparseDistMatrix& costMatrix, assignments_t& assignment, track_t maxCost)
+{
+    const size_t N = costMatrix.m_rows;
+    const size_t M = costMatrix.m_cols;
+
+    m_denseMatrix.assign(N * M, maxCost);
+    for (size_t i = 0; i < N; ++i)
+    {
+        for (size_t k = costMatrix.m_rowsStart[i]; k < costMatrix.m_rowsStart[i + 1]; ++k)
+        {
+            m_denseMatrix[i + costMatrix.m_colsInd[k] * N] = costMatrix.m_dists[k];
+        }
+    }
+    Solve(m_denseMatrix, N, M, assignment, maxCost);
+}
 
 ///
 /// \brief SPBipart::Solve
@@ -13,52 +31,64 @@
 /// \param assignment
 /// \param maxCost
 ///
-void SPBipart::Solve(const distMatrix_t& costMatrix, size_t N, size_t M, assignments_t& assignment, track_t maxCost)
+void SPBipart::Solve(const distMatrix_t& costMatrix, size_t N, size_t M, assignments_t& assignment, track_t /*maxCost*/)
 {
-    MyGraph G;
-    G.make_directed();
-
-    std::vector<GTL::node> nodes(N + M);
-
-    for (size_t i = 0; i < nodes.size(); ++i)
+    m_sparseMatrix.Reset(N, M);
+    for (size_t i = 0; i < N; ++i)
     {
-        nodes[i] = G.new_node();
+        for (size_t j = 0; j < M; ++j)
+        {
+            const track_t dist = costMatrix[i + j * N];
+            if (dist <= m_settings.m_distThres)
+                m_sparseMatrix.Add(static_cast<int>(j), dist);
+        }
+        m_sparseMatrix.FinishRow();
     }
+    m_solver.Solve(m_sparseMatrix, NotAssignedCost(), assignment);
+}
 
-	GTL::edge_map<int> weights(G, 100);
-    for (size_t i = 0; i < N; i++)
+///
+/// \brief SPBipart::Solve
+/// \param costMatrix
+/// \param assignment
+/// \param maxCost
+///
+void SPBipart::Solve(const SparseDistMatrix& costMatrix, assignments_t& assignment, track_t /*maxCost*/)
+{
+    m_sparseMatrix.Reset(costMatrix.m_rows, costMatrix.m_cols);
+    for (size_t i = 0; i < costMatrix.m_rows; ++i)
     {
-        bool hasZeroEdge = false;
-
-        for (size_t j = 0; j < M; j++)
+        for (size_t k = costMatrix.m_rowsStart[i]; k < costMatrix.m_rowsStart[i + 1]; ++k)
         {
-            track_t currCost = costMatrix[i + j * N];
-
-			GTL::edge e = G.new_edge(nodes[i], nodes[N + j]);
-
-            if (currCost < m_settings.m_distThres)
-            {
-                int weight = static_cast<int>(maxCost - currCost + 1);
-                G.set_edge_weight(e, weight);
-                weights[e] = weight;
-            }
-            else
-            {
-                if (!hasZeroEdge)
-                {
-                    G.set_edge_weight(e, 0);
-                    weights[e] = 0;
-                }
-                hasZeroEdge = true;
-            }
+            const track_t dist = costMatrix.m_dists[k];
+            if (dist <= m_settings.m_distThres)
+                m_sparseMatrix.Add(costMatrix.m_colsInd[k], dist);
         }
+        m_sparseMatrix.FinishRow();
     }
+    m_solver.Solve(m_sparseMatrix, NotAssignedCost(), assignment);
+}
 
-	GTL::edges_t L = MAX_WEIGHT_BIPARTITE_MATCHING(G, weights);
-    for (GTL::edges_t::iterator it = L.begin(); it != L.end(); ++it)
+///
+/// \brief SPSparseJV::Solve
+/// \param costMatrix
+/// \param N
+/// \param M
+/// \param assignment
+/// \param maxCost
+///
+void SPSparseJV::Solve(const distMatrix_t& costMatrix, size_t N, size_t M, assignments_t& assignment, track_t maxCost)
+{
+    m_sparseMatrix.Reset(N, M);
+    for (size_t i = 0; i < N; ++i)
     {
-        GTL::node a = it->source();
-        GTL::node b = it->target();
-        assignment[b.id()] = static_cast<assignments_t::value_type>(a.id() - N);
+        for (size_t j = 0; j < M; ++j)
+        {
+            const track_t dist = costMatrix[i + j * N];
+            if (dist <= m_settings.m_distThres)
+                m_sparseMatrix.Add(static_cast<int>(j), dist);
+        }
+        m_sparseMatrix.FinishRow();
     }
+    Solve(m_sparseMatrix, assignment, maxCost);
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include "defines.h"
 #include "HungarianAlg/HungarianAlg.h"
+#include "SparseJV/SparseJV.h"
+#include "LAPJV/LAPJV.h"
 
 ///
 /// \brief The SPSettings struct
@@ -24,9 +26,22 @@ public:
     virtual ~ShortPathCalculator() = default;
 
     virtual void Solve(const distMatrix_t& costMatrix, size_t N, size_t M, assignments_t& assignment, track_t maxCost) = 0;
+    virtual void Solve(const SparseDistMatrix& costMatrix, assignments_t& assignment, track_t maxCost);
+
+    ///
+    /// \brief SparseInput
+    /// \return true if solver works directly with sparse matrix
+    ///
+    virtual bool SparseInput() const
+    {
+        return false;
+    }
 
 protected:
     SPSettings m_settings;
+
+private:
+    distMatrix_t m_denseMatrix;
 };
 
 ///
@@ -40,6 +55,8 @@ public:
     {
     }
 
+    using ShortPathCalculator::Solve;
+
     void Solve(const distMatrix_t& costMatrix, size_t N, size_t M, assignments_t& assignment, track_t /*maxCost*/)
     {
         m_solver.Solve(costMatrix, N, M, assignment, AssignmentProblemSolver::optimal);
@@ -51,6 +68,9 @@ private:
 
 ///
 /// \brief The SPBipart class
+/// Maximum weight bipartite matching with weights m_distThres - cost + eps for pairs with distance not greater than m_distThres.
+/// It is the gated assignment: every not assigned track costs m_distThres + eps, so it is solved by SparseJVSolver
+/// with this cost of the not assigned row. Unlike SPSparseJV it prefers more pairs at the equal cost
 ///
 class SPBipart : public ShortPathCalculator
 {
@@ -61,4 +81,74 @@ public:
     }
 
     void Solve(const distMatrix_t& costMatrix, size_t N, size_t M, assignments_t& assignment, track_t maxCost);
+    void Solve(const SparseDistMatrix& costMatrix, assignments_t& assignment, track_t maxCost);
+
+    bool SparseInput() const
+    {
+        return true;
+    }
+
+private:
+    SparseJVSolver m_solver;
+    SparseDistMatrix m_sparseMatrix;
+
+    ///
+    /// \brief NotAssignedCost
+    /// The cost doesn't depend on maxCost: with maxCost = frame area the float costs lose their differences
+    /// \return m_distThres + eps
+    ///
+    track_t NotAssignedCost() const
+    {
+        return m_settings.m_distThres + m_settings.m_distThres * 1e-3f;
+    }
+};
+
+///
+/// \brief The SPLAPJV class
+///
+class SPLAPJV : public ShortPathCalculator
+{
+public:
+    SPLAPJV(const SPSettings& settings)
+        : ShortPathCalculator(settings)
+    {
+    }
+
+    using ShortPathCalculator::Solve;
+
+    void Solve(const distMatrix_t& costMatrix, size_t N, size_t M, assignments_t& assignment, track_t /*maxCost*/)
+    {
+        m_solver.Solve(costMatrix, N, M, assignment);
+    }
+
+private:
+    LAPJVSolver m_solver;
+};
+
+///
+/// \brief The SPSparseJV class
+/// Assignment only on the pairs with distance less than m_distThres
+///
+class SPSparseJV : public ShortPathCalculator
+{
+public:
+    SPSparseJV(const SPSettings& settings)
+        : ShortPathCalculator(settings)
+    {
+    }
+
+    void Solve(const distMatrix_t& costMatrix, size_t N, size_t M, assignments_t& assignment, track_t maxCost);
+    void Solve(const SparseDistMatrix& costMatrix, assignments_t& assignment, track_t /*maxCost*/)
+    {
+        m_solver.Solve(costMatrix, m_settings.m_distThres, assignment);
+    }
+
+    bool SparseInput() const
+    {
+        return true;
+    }
+
+private:
+    SparseJVSolver m_solver;
+    SparseDistMatrix m_sparseMatrix;
 };
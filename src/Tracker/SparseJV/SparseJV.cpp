@@ -0,0 +1,168 @@
+#include "SparseJV.h"
+#include <algorithm>
+#include <functional>
+
+///
+/// \brief SparseJVSolver::Solve
+/// \param costMatrix - rows are tracks, columns are regions
+/// \param maxDist - maximal distance for the assigned pair, cost of the not assigned row
+/// \param assignment - region index for every row or -1
+/// \return Total cost of the assigned pairs
+///
+track_t SparseJVSolver::Solve(const SparseDistMatrix& costMatrix, track_t maxDist, assignments_t& assignment)
+{
+    const size_t N = costMatrix.m_rows;
+    const size_t M = costMatrix.m_cols;
+    const size_t colsCount = M + N;
+
+    m_colsPotential.assign(colsCount, 0);
+    m_colsRow.assign(colsCount, -1);
+    m_rowsCol.assign(N, -1);
+    m_rowsCost.assign(N, 0);
+
+    m_dist.assign(colsCount, INF_DIST);
+    m_pred.assign(colsCount, -1);
+    m_predCost.assign(colsCount, 0);
+    m_scanned.assign(colsCount, 0);
+
+    for (size_t row = 0; row < N; ++row)
+    {
+        Augment(costMatrix, maxDist, static_cast<int>(row));
+    }
+
+    assignment.assign(N, -1);
+    track_t cost = 0;
+    for (size_t row = 0; row < N; ++row)
+    {
+        if (m_rowsCol[row] >= 0 && static_cast<size_t>(m_rowsCol[row]) < M)
+        {
+            assignment[row] = m_rowsCol[row];
+            cost += m_rowsCost[row];
+        }
+    }
+    return cost;
+}
+
+///
+/// \brief SparseJVSolver::Augment
+/// Dijkstra search of the shortest augmenting path from the free row
+/// \param costMatrix
+/// \param maxDist
+/// \param freeRow
+/// \return
+///
+bool SparseJVSolver::Augment(const SparseDistMatrix& costMatrix, track_t maxDist, int freeRow)
+{
+    auto HeapCmp = std::greater<std::pair<track_t, int>>();
+
+    m_touched.clear();
+    m_scannedCols.clear();
+    m_heap.clear();
+
+    RelaxRow(costMatrix, maxDist, freeRow, 0);
+
+    int sink = -1;
+    track_t sinkDist = 0;
+    while (!m_heap.empty())
+    {
+        std::pop_heap(m_heap.begin(), m_heap.end(), HeapCmp);
+        const auto top = m_heap.back();
+        m_heap.pop_back();
+
+        const int col = top.second;
+        if (m_scanned[col] || top.first > m_dist[col])
+            continue;
+
+        if (m_colsRow[col] < 0)
+        {
+            sink = col;
+            sinkDist = top.first;
+            break;
+        }
+
+        m_scanned[col] = 1;
+        m_scannedCols.push_back(col);
+
+        // Continue the path through the row assigned to this column
+        const int row = m_colsRow[col];
+        RelaxRow(costMatrix, maxDist, row, top.first - (m_rowsCost[row] - m_colsPotential[col]));
+    }
+
+    bool res = sink >= 0;
+    if (res)
+    {
+        // Update potentials of the scanned columns
+        for (int col : m_scannedCols)
+        {
+            m_colsPotential[col] += m_dist[col] - sinkDist;
+        }
+
+        // Augment along the path
+        for (int col = sink;;)
+        {
+            const int row = m_pred[col];
+            const int prevCol = m_rowsCol[row];
+            m_colsRow[col] = row;
+            m_rowsCol[row] = col;
+            m_rowsCost[row] = m_predCost[col];
+            if (row == freeRow)
+                break;
+            col = prevCol;
+        }
+    }
+
+    for (int col : m_touched)
+    {
+        m_dist[col] = INF_DIST;
+        m_pred[col] = -1;
+        m_scanned[col] = 0;
+    }
+    return res;
+}
+
+///
+/// \brief SparseJVSolver::RelaxRow
+/// \param costMatrix
+/// \param maxDist
+/// \param row
+/// \param rowOffset - path length to the row
+///
+void SparseJVSolver::RelaxRow(const SparseDistMatrix& costMatrix, track_t maxDist, int row, track_t rowOffset)
+{
+    for (size_t i = costMatrix.m_rowsStart[row]; i < costMatrix.m_rowsStart[row + 1]; ++i)
+    {
+        const track_t dist = costMatrix.m_dists[i];
+        if (dist > maxDist)
+            continue;
+        const int col = costMatrix.m_colsInd[i];
+        Relax(col, rowOffset + dist - m_colsPotential[col], row, dist);
+    }
+    // Virtual "not assigned" column for this row
+    const int virtCol = static_cast<int>(costMatrix.m_cols) + row;
+    Relax(virtCol, rowOffset + maxDist - m_colsPotential[virtCol], row, maxDist);
+}
+
+///
+/// \brief SparseJVSolver::Relax
+/// \param col
+/// \param dist
+/// \param row
+/// \param cost
+///
+void SparseJVSolver::Relax(int col, track_t dist, int row, track_t cost)
+{
+    if (m_scanned[col])
+        return;
+
+    if (m_pred[col] < 0)
+        m_touched.push_back(col);
+
+    if (dist < m_dist[col])
+    {
+        m_dist[col] = dist;
+        m_pred[col] = row;
+        m_predCost[col] = cost;
+        m_heap.emplace_back(dist, col);
+        std::push_heap(m_heap.begin(), m_heap.end(), std::greater<std::pair<track_t, int>>());
+    }
+}
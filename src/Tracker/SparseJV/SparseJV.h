@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include <limits>
+#include "defines.h"
+
+///
+/// \brief The SparseJVSolver class
+/// Shortest augmenting path (Jonker-Volgenant) assignment only on the admissible edges of the sparse matrix.
+/// Every row can be left unassigned with the cost maxDist, so pairs with distance greater than maxDist are never assigned
+///
+class SparseJVSolver
+{
+public:
+    SparseJVSolver() = default;
+    ~SparseJVSolver() = default;
+
+    track_t Solve(const SparseDistMatrix& costMatrix, track_t maxDist, assignments_t& assignment);
+
+private:
+    static constexpr track_t INF_DIST = std::numeric_limits<track_t>::max();
+
+    // Columns are regions and one virtual "not assigned" column for every row
+    std::vector<track_t> m_colsPotential;
+    std::vector<int> m_colsRow;
+    std::vector<int> m_rowsCol;
+    std::vector<track_t> m_rowsCost;
+
+    // Dijkstra buffers
+    std::vector<track_t> m_dist;
+    std::vector<int> m_pred;
+    std::vector<track_t> m_predCost;
+    std::vector<char> m_scanned;
+    std::vector<int> m_touched;
+    std::vector<int> m_scannedCols;
+    std::vector<std::pair<track_t, int>> m_heap;
+
+    bool Augment(const SparseDistMatrix& costMatrix, track_t maxDist, int freeRow);
+    void RelaxRow(const SparseDistMatrix& costMatrix, track_t maxDist, int row, track_t rowOffset);
+    void Relax(int col, track_t dist, int row, track_t cost);
+};
@@ -0,0 +1,163 @@
+#include "SpatialGrid.h"
+
+///
+/// \brief SpatialGrid::Build
+/// Rebuild the grid for the new regions, one region per cell in average
+/// \param regions
+///
+void SpatialGrid::Build(const regions_t& regions)
+{
+    m_centers.clear();
+    m_cellsRegions.clear();
+    m_regionsCells.clear();
+    m_maxLeft = 0;
+    m_maxTop = 0;
+    m_maxRight = 0;
+    m_maxBottom = 0;
+
+    if (regions.empty())
+    {
+        m_gridSize = cv::Size(0, 0);
+        m_cellsStart.assign(1, 0);
+        return;
+    }
+
+    Point_t minPt = regions[0].m_rrect.center;
+    Point_t maxPt = minPt;
+    m_centers.reserve(regions.size());
+    for (const auto& reg : regions)
+    {
+        const Point_t& pt = reg.m_rrect.center;
+        m_centers.push_back(pt);
+
+        minPt.x = std::min(minPt.x, pt.x);
+        minPt.y = std::min(minPt.y, pt.y);
+        maxPt.x = std::max(maxPt.x, pt.x);
+        maxPt.y = std::max(maxPt.y, pt.y);
+
+        // Bounding rectangle is measured from the same center that is indexed: for the regions created from rotated rectangles they are not concentric
+        m_maxLeft = std::max(m_maxLeft, pt.x - reg.m_brect.x);
+        m_maxTop = std::max(m_maxTop, pt.y - reg.m_brect.y);
+        m_maxRight = std::max(m_maxRight, reg.m_brect.x + reg.m_brect.width - pt.x);
+        m_maxBottom = std::max(m_maxBottom, reg.m_brect.y + reg.m_brect.height - pt.y);
+    }
+
+    const track_t width = std::max(maxPt.x - minPt.x, static_cast<track_t>(1));
+    const track_t height = std::max(maxPt.y - minPt.y, static_cast<track_t>(1));
+    m_cellSize = std::max(sqrtf(width * height / static_cast<track_t>(regions.size())), static_cast<track_t>(1));
+    m_cellSize = std::max(m_cellSize, std::max(width, height) / MAX_GRID_SIDE);
+    m_origin = minPt;
+    m_gridSize.width = std::min(static_cast<int>(width / m_cellSize) + 1, MAX_GRID_SIDE);
+    m_gridSize.height = std::min(static_cast<int>(height / m_cellSize) + 1, MAX_GRID_SIDE);
+
+    // Counting sort of the regions by cells
+    m_cellsStart.assign(static_cast<size_t>(m_gridSize.area()) + 1, 0);
+    m_regionsCells.resize(m_centers.size());
+    for (size_t i = 0; i < m_centers.size(); ++i)
+    {
+        int cell = CellX(m_centers[i].x) + CellY(m_centers[i].y) * m_gridSize.width;
+        m_regionsCells[i] = cell;
+        ++m_cellsStart[cell + 1];
+    }
+    for (size_t i = 1; i < m_cellsStart.size(); ++i)
+    {
+        m_cellsStart[i] += m_cellsStart[i - 1];
+    }
+    m_cellsRegions.resize(m_centers.size());
+    std::vector<int> cellsPos(m_cellsStart.begin(), m_cellsStart.end() - 1);
+    for (size_t i = 0; i < m_centers.size(); ++i)
+    {
+        m_cellsRegions[cellsPos[m_regionsCells[i]]++] = static_cast<int>(i);
+    }
+}
+
+///
+/// \brief SpatialGrid::Query
+/// Find all regions with centers inside area
+/// \param area
+/// \param regionsInd - sorted regions indexes
+///
+void SpatialGrid::Query(const cv::Rect_<track_t>& area, std::vector<int>& regionsInd) const
+{
+    regionsInd.clear();
+    if (m_centers.empty())
+        return;
+
+    const track_t x2 = area.x + area.width;
+    const track_t y2 = area.y + area.height;
+    if (x2 < m_origin.x || y2 < m_origin.y)
+        return;
+
+    const int cx1 = CellX(area.x);
+    const int cx2 = CellX(x2);
+    const int cy1 = CellY(area.y);
+    const int cy2 = CellY(y2);
+    for (int cy = cy1; cy <= cy2; ++cy)
+    {
+        for (int cx = cx1; cx <= cx2; ++cx)
+        {
+            const int cell = cx + cy * m_gridSize.width;
+            for (int i = m_cellsStart[cell]; i < m_cellsStart[cell + 1]; ++i)
+            {
+                const int regInd = m_cellsRegions[i];
+                const Point_t& pt = m_centers[regInd];
+                if (pt.x >= area.x && pt.x <= x2 && pt.y >= area.y && pt.y <= y2)
+                    regionsInd.push_back(regInd);
+            }
+        }
+    }
+    std::sort(regionsInd.begin(), regionsInd.end());
+}
+
+///
+/// \brief SpatialGrid::GateRect
+/// Rectangle for Query with all the regions centers that can be closer than the maximal distance:
+/// inside the prediction ellipse (EllipseGate distance <= 1) or with the bounding rectangle intersected with the last track rectangle
+/// \param predictedArea - result of CTrack::CalcPredictionEllipse
+/// \param lastRect - last track rectangle
+/// \param withLastRect - also include all regions intersected with the last track rectangle
+/// \return
+///
+cv::Rect_<track_t> SpatialGrid::GateRect(const cv::RotatedRect& predictedArea, const cv::Rect& lastRect, bool withLastRect) const
+{
+    // Ellipse half sizes are equal to the rrect size (see EllipseGate), angle in radians
+    const track_t cosA = cosf(predictedArea.angle);
+    const track_t sinA = sinf(predictedArea.angle);
+    const track_t w = predictedArea.size.width;
+    const track_t h = predictedArea.size.height;
+    const track_t hw = sqrtf(w * cosA * w * cosA + h * sinA * h * sinA);
+    const track_t hh = sqrtf(w * sinA * w * sinA + h * cosA * h * cosA);
+    cv::Rect_<track_t> gate(predictedArea.center.x - hw, predictedArea.center.y - hh, 2 * hw, 2 * hh);
+
+    if (withLastRect)
+    {
+        // The region bounding rectangle [c.x - left, c.x + right] intersects [lastRect.x, lastRect.x + lastRect.width]
+        // only if its center c.x is inside [lastRect.x - right, lastRect.x + lastRect.width + left], the same for y
+        cv::Rect_<track_t> extRect(lastRect.x - m_maxRight, lastRect.y - m_maxBottom,
+                                   lastRect.width + m_maxLeft + m_maxRight, lastRect.height + m_maxTop + m_maxBottom);
+        gate = gate | extRect;
+    }
+    return gate;
+}
+
+///
+/// \brief SpatialGrid::CellX
+/// \param x
+/// \return
+///
+int SpatialGrid::CellX(track_t x) const
+{
+    int cell = static_cast<int>((x - m_origin.x) / m_cellSize);
+    return std::max(0, std::min(cell, m_gridSize.width - 1));
+}
+
+///
+/// \brief SpatialGrid::CellY
+/// \param y
+/// \return
+///
+int SpatialGrid::CellY(track_t y) const
+{
+    int cell = static_cast<int>((y - m_origin.y) / m_cellSize);
+    return std::max(0, std::min(cell, m_gridSize.height - 1));
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+
+#include "defines.h"
+
+///
+/// \brief The SpatialGrid class
+/// Uniform grid over the regions centers for the fast search of the regions inside the track gate
+///
+class SpatialGrid
+{
+public:
+    SpatialGrid() = default;
+    ~SpatialGrid() = default;
+
+    void Build(const regions_t& regions);
+    void Query(const cv::Rect_<track_t>& area, std::vector<int>& regionsInd) const;
+
+    cv::Rect_<track_t> GateRect(const cv::RotatedRect& predictedArea, const cv::Rect& lastRect, bool withLastRect) const;
+
+private:
+    std::vector<Point_t> m_centers;
+    std::vector<int> m_cellsStart;   // m_gridSize.area() + 1 offsets in m_cellsRegions
+    std::vector<int> m_cellsRegions; // Regions indexes sorted by cells
+    std::vector<int> m_regionsCells;
+
+    Point_t m_origin;
+    track_t m_cellSize = 1;
+    cv::Size m_gridSize;
+    // Maximal distances from the indexed centers (m_rrect.center) to the sides of the regions bounding rectangles (m_brect)
+    track_t m_maxLeft = 0;
+    track_t m_maxTop = 0;
+    track_t m_maxRight = 0;
+    track_t m_maxBottom = 0;
+
+    static constexpr int MAX_GRID_SIDE = 256;
+
+    int CellX(track_t x) const;
+    int CellY(track_t y) const;
+};
@@ -0,0 +1,55 @@
+#include "TracksTable.h"
+
+///
+/// \brief TracksTable::PushBack
+/// \param track
+///
+void TracksTable::PushBack(CTrack& track)
+{
+    m_lastRegions.push_back(track.LastRegion());
+    m_predictionPoints.push_back(track.PredictionPoint());
+    m_velocities.push_back(track.GetVelocity());
+    m_positionCovs.push_back(track.GetPositionCov());
+    m_skippedFrames.push_back(0);
+    m_outOfTheFrame.push_back(track.IsOutOfTheFrame());
+    m_filters.push_back(&track.Kalman());
+    m_predictionAreas.emplace_back();
+}
+
+///
+/// \brief TracksTable::Refresh
+/// Copy the track state after update
+/// \param i
+/// \param track
+///
+void TracksTable::Refresh(size_t i, const CTrack& track)
+{
+    m_lastRegions[i] = track.LastRegion();
+    m_predictionPoints[i] = track.PredictionPoint();
+    m_velocities[i] = track.GetVelocity();
+    m_positionCovs[i] = track.GetPositionCov();
+    m_outOfTheFrame[i] = track.IsOutOfTheFrame();
+}
+
+///
+/// \brief TracksTable::SwapAndPop
+/// Remove row: the last row is moved to its place
+/// \param i
+///
+void TracksTable::SwapAndPop(size_t i)
+{
+    auto SwapAndPopOne = [i](auto& arr)
+    {
+        if (i + 1 != arr.size())
+            std::swap(arr[i], arr.back());
+        arr.pop_back();
+    };
+    SwapAndPopOne(m_lastRegions);
+    SwapAndPopOne(m_predictionPoints);
+    SwapAndPopOne(m_velocities);
+    SwapAndPopOne(m_positionCovs);
+    SwapAndPopOne(m_skippedFrames);
+    SwapAndPopOne(m_outOfTheFrame);
+    SwapAndPopOne(m_filters);
+    SwapAndPopOne(m_predictionAreas);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+
+#include "defines.h"
+#include "track.h"
+
+///
+/// \brief The TracksTable class
+/// Hot per-frame data of the tracks in the structure of arrays. Row i belongs to the track CTracker::m_tracks[i]
+///
+class TracksTable
+{
+public:
+    TracksTable() = default;
+    ~TracksTable() = default;
+
+    void PushBack(CTrack& track);
+    void Refresh(size_t i, const CTrack& track);
+    void SwapAndPop(size_t i);
+
+    ///
+    /// \brief Size
+    /// \return
+    ///
+    size_t Size() const
+    {
+        return m_lastRegions.size();
+    }
+
+    std::vector<CRegion> m_lastRegions;
+    std::vector<Point_t> m_predictionPoints;
+    std::vector<cv::Vec<track_t, 2>> m_velocities;
+    std::vector<cv::Matx<track_t, 2, 2>> m_positionCovs;
+    std::vector<size_t> m_skippedFrames;
+    std::vector<char> m_outOfTheFrame;
+    std::vector<TKalmanFilter*> m_filters; // Filters of the tracks for TKalmanFilter::PredictBatch
+
+    std::vector<cv::RotatedRect> m_predictionAreas; // Calculated for the current frame in CTracker::CreateDistaceMatrix
+};
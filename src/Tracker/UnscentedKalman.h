@@ -0,0 +1,374 @@
+#pragma once
+#include <algorithm>
+#include "LinearKalman.h"
+
+///
+/// \brief The UkfAcceleratedModel struct
+/// Constant acceleration model: state is (measured values, vx, vy, ax, ay), the other measured values (width, height) are constant
+///
+template<int MEAS>
+struct UkfAcceleratedModel
+{
+    static constexpr int STATE_SIZE = MEAS + 4;
+    static constexpr int MEAS_SIZE = MEAS;
+
+    ///
+    /// \brief Transition
+    /// \param x
+    /// \param xNext
+    /// \param dt
+    ///
+    static void Transition(const track_t* x, track_t* xNext, track_t dt)
+    {
+        const track_t dt2 = dt * dt / 2;
+        for (int i = 0; i < STATE_SIZE; ++i)
+        {
+            xNext[i] = x[i];
+        }
+        xNext[0] += x[MEAS] * dt + x[MEAS + 2] * dt2;
+        xNext[1] += x[MEAS + 1] * dt + x[MEAS + 3] * dt2;
+        xNext[MEAS] += x[MEAS + 2] * dt;
+        xNext[MEAS + 1] += x[MEAS + 3] * dt;
+    }
+
+    ///
+    /// \brief Measurement
+    /// \param x
+    /// \param z
+    ///
+    static void Measurement(const track_t* x, track_t* z)
+    {
+        for (int i = 0; i < MEAS; ++i)
+        {
+            z[i] = x[i];
+        }
+    }
+};
+
+///
+/// \brief The TUnscentedKalman class
+/// Unscented Kalman filter with the compile time sizes and additive noises.
+/// Sigma points, weights and covariances are preallocated cv::Matx members, nothing is allocated on predict or correct.
+/// The augmented version adds the process and measurement noises to the sigma points state
+///
+template<class MODEL, bool AUGMENTED>
+class TUnscentedKalman
+{
+public:
+    static constexpr int STATE = MODEL::STATE_SIZE;
+    static constexpr int MEAS = MODEL::MEAS_SIZE;
+    static constexpr int AUG = AUGMENTED ? (2 * STATE + MEAS) : STATE;
+    static constexpr int SIGMA = 2 * AUG + 1;
+
+    typedef cv::Matx<track_t, STATE, 1> state_t;
+    typedef cv::Matx<track_t, MEAS, 1> meas_t;
+    typedef cv::Matx<track_t, STATE, STATE> cov_t;
+
+    ///
+    /// \brief Init
+    /// \param state0
+    /// \param processNoise - diagonal of the process noise covariance
+    /// \param measurementNoise - diagonal of the measurement noise covariance
+    /// \param errorCov
+    /// \param deltaTime
+    /// \param alpha
+    /// \param beta
+    /// \param k
+    ///
+    void Init(const state_t& state0, const state_t& processNoise, const meas_t& measurementNoise, track_t errorCov, track_t deltaTime,
+              track_t alpha = 1, track_t beta = 2, track_t k = -2)
+    {
+        m_state = state0;
+        m_errorCov = cov_t::eye() * errorCov;
+        m_processNoise = cov_t::zeros();
+        for (int i = 0; i < STATE; ++i)
+        {
+            m_processNoise(i, i) = processNoise(i);
+        }
+        m_measurementNoise = cv::Matx<track_t, MEAS, MEAS>::zeros();
+        for (int i = 0; i < MEAS; ++i)
+        {
+            m_measurementNoise(i, i) = measurementNoise(i);
+        }
+        m_deltaTime = deltaTime;
+
+        const track_t lambda = alpha * alpha * (AUG + k) - AUG;
+        m_gamma = std::sqrt(AUG + lambda);
+        m_weightsMean[0] = lambda / (AUG + lambda);
+        m_weightsCov[0] = m_weightsMean[0] + 1 - alpha * alpha + beta;
+        for (int i = 1; i < SIGMA; ++i)
+        {
+            m_weightsMean[i] = 1 / (2 * (AUG + lambda));
+            m_weightsCov[i] = m_weightsMean[i];
+        }
+        m_predicted = false;
+    }
+
+    ///
+    /// \brief Predict
+    /// \return
+    ///
+    const state_t& Predict()
+    {
+        GenerateSigmaPoints(true);
+        CalcStateStatistics();
+        if constexpr (!AUGMENTED)
+            m_errorCov += m_processNoise;
+
+        m_predicted = true;
+        return m_state;
+    }
+
+    ///
+    /// \brief Correct
+    /// \param measurement
+    /// \return
+    ///
+    const state_t& Correct(const meas_t& measurement)
+    {
+        // Sigma points around the current state if it was already corrected after prediction
+        if (!m_predicted)
+        {
+            GenerateSigmaPoints(false);
+            CalcStateStatistics();
+        }
+        m_predicted = false;
+
+        meas_t measMean = meas_t::zeros();
+        for (int s = 0; s < SIGMA; ++s)
+        {
+            track_t* z = &m_sigmaMeas.val[s * MEAS];
+            MODEL::Measurement(&m_sigmaStates.val[s * STATE], z);
+            for (int i = 0; i < MEAS; ++i)
+            {
+                if constexpr (AUGMENTED)
+                    z[i] += m_sigmaMeasNoise(s, i);
+                measMean(i) += m_weightsMean[s] * z[i];
+            }
+        }
+
+        cv::Matx<track_t, MEAS, MEAS> innovCov = AUGMENTED ? cv::Matx<track_t, MEAS, MEAS>::zeros() : m_measurementNoise;
+        cv::Matx<track_t, MEAS, STATE> crossCov = cv::Matx<track_t, MEAS, STATE>::zeros();
+        for (int s = 0; s < SIGMA; ++s)
+        {
+            meas_t dz;
+            for (int i = 0; i < MEAS; ++i)
+            {
+                dz(i) = m_sigmaMeas(s, i) - measMean(i);
+            }
+            for (int i = 0; i < MEAS; ++i)
+            {
+                const track_t wdz = m_weightsCov[s] * dz(i);
+                for (int j = 0; j < MEAS; ++j)
+                {
+                    innovCov(i, j) += wdz * dz(j);
+                }
+                for (int j = 0; j < STATE; ++j)
+                {
+                    crossCov(i, j) += wdz * (m_sigmaStates(s, j) - m_state(j));
+                }
+            }
+        }
+
+        // K^T = S^-1 * Pzx
+        cv::Matx<track_t, MEAS, STATE> gainT = crossCov;
+        if (!CholeskySolve(innovCov, gainT))
+            return m_state;
+
+        for (int i = 0; i < STATE; ++i)
+        {
+            track_t s = m_state(i);
+            for (int k = 0; k < MEAS; ++k)
+            {
+                s += gainT(k, i) * (measurement(k) - measMean(k));
+            }
+            m_state(i) = s;
+        }
+        // P = P - K * S * K^T = P - K * Pzx
+        for (int i = 0; i < STATE; ++i)
+        {
+            for (int j = 0; j < STATE; ++j)
+            {
+                track_t s = m_errorCov(i, j);
+                for (int k = 0; k < MEAS; ++k)
+                {
+                    s -= gainT(k, i) * crossCov(k, j);
+                }
+                m_errorCov(i, j) = s;
+            }
+        }
+        return m_state;
+    }
+
+    ///
+    /// \brief GetVelocity
+    /// \return
+    ///
+    cv::Vec<track_t, 2> GetVelocity() const
+    {
+        return cv::Vec<track_t, 2>(m_state(MEAS), m_state(MEAS + 1));
+    }
+
+    ///
+    /// \brief PositionCov
+    /// \return Covariance of the first two measured values
+    ///
+    cv::Matx<track_t, 2, 2> PositionCov() const
+    {
+        cv::Matx<track_t, 2, 2> cov;
+        for (int i = 0; i < 2; ++i)
+        {
+            for (int j = 0; j < 2; ++j)
+            {
+                cov(i, j) = m_errorCov(i, j);
+            }
+        }
+        return cov;
+    }
+
+    ///
+    /// \brief SetDeltaTime
+    /// \param deltaTime
+    ///
+    void SetDeltaTime(track_t deltaTime)
+    {
+        m_deltaTime = deltaTime;
+    }
+
+private:
+    state_t m_state;
+    cov_t m_errorCov;
+    cov_t m_processNoise;
+    cv::Matx<track_t, MEAS, MEAS> m_measurementNoise;
+    track_t m_deltaTime = 0;
+
+    track_t m_gamma = 1;
+    track_t m_weightsMean[SIGMA];
+    track_t m_weightsCov[SIGMA];
+
+    cv::Matx<track_t, AUG, AUG> m_sqrtCov;             // Cholesky factor of the (augmented) covariance
+    cv::Matx<track_t, SIGMA, STATE> m_sigmaStates;     // One sigma point in row
+    cv::Matx<track_t, SIGMA, MEAS> m_sigmaMeas;
+    cv::Matx<track_t, SIGMA, MEAS> m_sigmaMeasNoise;   // Only for the augmented version
+    bool m_predicted = false;
+
+    ///
+    /// \brief GenerateSigmaPoints
+    /// \param transition - propagate sigma points through the motion model
+    ///
+    void GenerateSigmaPoints(bool transition)
+    {
+        m_sqrtCov = cv::Matx<track_t, AUG, AUG>::zeros();
+        for (int i = 0; i < STATE; ++i)
+        {
+            for (int j = 0; j < STATE; ++j)
+            {
+                m_sqrtCov(i, j) = (m_errorCov(i, j) + m_errorCov(j, i)) / 2;
+            }
+        }
+        if constexpr (AUGMENTED)
+        {
+            for (int i = 0; i < STATE; ++i)
+            {
+                m_sqrtCov(STATE + i, STATE + i) = m_processNoise(i, i);
+            }
+            for (int i = 0; i < MEAS; ++i)
+            {
+                m_sqrtCov(2 * STATE + i, 2 * STATE + i) = m_measurementNoise(i, i);
+            }
+        }
+        if (!CholeskyDecomp(m_sqrtCov))
+        {
+            // Covariance lost positive definiteness: restart from its diagonal
+            for (int i = 0; i < STATE; ++i)
+            {
+                for (int j = 0; j < STATE; ++j)
+                {
+                    m_errorCov(i, j) = (i == j) ? (std::abs(m_errorCov(i, i)) + m_processNoise(i, i)) : 0;
+                }
+            }
+            m_sqrtCov = cv::Matx<track_t, AUG, AUG>::zeros();
+            for (int i = 0; i < STATE; ++i)
+            {
+                m_sqrtCov(i, i) = std::sqrt(m_errorCov(i, i));
+            }
+            if constexpr (AUGMENTED)
+            {
+                for (int i = 0; i < STATE; ++i)
+                {
+                    m_sqrtCov(STATE + i, STATE + i) = std::sqrt(m_processNoise(i, i));
+                }
+                for (int i = 0; i < MEAS; ++i)
+                {
+                    m_sqrtCov(2 * STATE + i, 2 * STATE + i) = std::sqrt(m_measurementNoise(i, i));
+                }
+            }
+        }
+
+        // Point s: mean +- gamma * column of the sqrt covariance
+        track_t point[AUG];
+        for (int s = 0; s < SIGMA; ++s)
+        {
+            const int col = (s - 1) % AUG;
+            const track_t sign = (s == 0) ? 0 : ((s <= AUG) ? m_gamma : -m_gamma);
+            for (int i = 0; i < AUG; ++i)
+            {
+                point[i] = ((i < STATE) ? m_state(i) : 0) + ((s == 0) ? 0 : sign * m_sqrtCov(i, col));
+            }
+
+            track_t* x = &m_sigmaStates.val[s * STATE];
+            if (transition)
+                MODEL::Transition(point, x, m_deltaTime);
+            else
+                std::copy(point, point + STATE, x);
+
+            if constexpr (AUGMENTED)
+            {
+                if (transition)
+                {
+                    for (int i = 0; i < STATE; ++i)
+                    {
+                        x[i] += point[STATE + i];
+                    }
+                }
+                for (int i = 0; i < MEAS; ++i)
+                {
+                    m_sigmaMeasNoise(s, i) = point[2 * STATE + i];
+                }
+            }
+        }
+    }
+
+    ///
+    /// \brief CalcStateStatistics
+    /// Weighted mean and covariance of the sigma points
+    ///
+    void CalcStateStatistics()
+    {
+        m_state = state_t::zeros();
+        for (int s = 0; s < SIGMA; ++s)
+        {
+            for (int i = 0; i < STATE; ++i)
+            {
+                m_state(i) += m_weightsMean[s] * m_sigmaStates(s, i);
+            }
+        }
+        m_errorCov = cov_t::zeros();
+        state_t dx;
+        for (int s = 0; s < SIGMA; ++s)
+        {
+            for (int i = 0; i < STATE; ++i)
+            {
+                dx(i) = m_sigmaStates(s, i) - m_state(i);
+            }
+            for (int i = 0; i < STATE; ++i)
+            {
+                const track_t wdx = m_weightsCov[s] * dx(i);
+                for (int j = 0; j < STATE; ++j)
+                {
+                    m_errorCov(i, j) += wdx * dx(j);
+                }
+            }
+        }
+    }
+};
@@ -25,7 +25,7 @@ CTrack::CTrack(const CRegion& region,
                bool filterObjectSize,
                tracking::LostTrackType externalTrackerForLost)
     :
-      m_kalman(kalmanType, useAcceleration, deltaTime, accelNoiseMag),
+      m_kalman(kalmanType, useAcceleration, filterObjectSize, deltaTime, accelNoiseMag),
       m_lastRegion(region),
       m_predictionRect(region.m_rrect),
       m_predictionPoint(region.m_rrect.center),
@@ -53,6 +53,7 @@ CTrack::CTrack(const CRegion& region,
 /// \param trackID
 /// \param filterObjectSize
 /// \param externalTrackerForLost
+/// \param embeddingsGallerySize
 ///
 CTrack::CTrack(const CRegion& region,
                const RegionEmbedding& regionEmbedding,
@@ -62,15 +63,17 @@ CTrack::CTrack(const CRegion& region,
                bool useAcceleration,
                size_t trackID,
                bool filterObjectSize,
-               tracking::LostTrackType externalTrackerForLost)
+               tracking::LostTrackType externalTrackerForLost,
+               size_t embeddingsGallerySize)
     :
-      m_kalman(kalmanType, useAcceleration, deltaTime, accelNoiseMag),
+      m_kalman(kalmanType, useAcceleration, filterObjectSize, deltaTime, accelNoiseMag),
       m_lastRegion(region),
       m_predictionRect(region.m_rrect),
       m_predictionPoint(region.m_rrect.center),
       m_trackID(trackID),
       m_externalTrackerForLost(externalTrackerForLost),
       m_regionEmbedding(regionEmbedding),
+      m_embeddingsGallery(embeddingsGallerySize),
       m_filterObjectSize(filterObjectSize)
 {
     if (filterObjectSize)
@@ -78,6 +81,8 @@ CTrack::CTrack(const CRegion& region,
     else
         m_kalman.Update(m_predictionPoint, true);
 
+    m_embeddingsGallery.Add(regionEmbedding.m_embedding);
+
     m_trace.push_back(m_predictionPoint, m_predictionPoint);
 }
 
@@ -115,65 +120,48 @@ track_t CTrack::CalcDistRect(const CRegion& reg) const
 }
 
 ///
-/// \brief CTrack::CalcDistJaccard
-/// \param reg
+/// \brief CTrack::CalcDistHist
+/// Bhattacharyya distance: the embeddings are square roots of the normalized histograms
+/// \param embedding
 /// \return
 ///
-track_t CTrack::CalcDistJaccard(const CRegion& reg) const
+track_t CTrack::CalcDistHist(const RegionEmbedding& embedding) const
 {
-    track_t intArea = static_cast<track_t>((reg.m_brect & m_lastRegion.m_brect).area());
-    track_t unionArea = static_cast<track_t>(reg.m_brect.area() + m_lastRegion.m_brect.area() - intArea);
+	track_t res = 1;
 
-    return 1 - intArea / unionArea;
+    if (!embedding.m_hist.empty() && embedding.m_hist.total() == m_regionEmbedding.m_hist.total())
+	{
+        const float* hist1 = embedding.m_hist.ptr<float>();
+        const float* hist2 = m_regionEmbedding.m_hist.ptr<float>();
+        float coeff = 0;
+        for (size_t i = 0, stop = embedding.m_hist.total(); i < stop; ++i)
+        {
+            coeff += hist1[i] * hist2[i];
+        }
+        res = sqrtf(std::max(0.f, 1.f - coeff));
+	}
+	return res;
 }
 
 ///
-/// \brief CTrack::CalcDistHist
-/// \param reg
+/// \brief CTrack::CalcDistFeature
+/// \param embedding
 /// \return
 ///
-track_t CTrack::CalcDistHist(const CRegion& reg, cv::Mat& hist, cv::UMat currFrame) const
+track_t CTrack::CalcDistFeature(const RegionEmbedding& embedding) const
 {
-	track_t res = 1;
-
-    if (hist.empty())
-	{
-		int bins = 64;
-		std::vector<int> histSize;
-		std::vector<float> ranges;
-		std::vector<int> channels;
-
-		for (int i = 0, stop = currFrame.channels(); i < stop; ++i)
-		{
-			histSize.push_back(bins);
-			ranges.push_back(0);
-			ranges.push_back(255);
-			channels.push_back(i);
-		}
-
-		std::vector<cv::UMat> regROI = { currFrame(reg.m_brect) };
-        cv::calcHist(regROI, channels, cv::Mat(), hist, histSize, ranges, false);
-        cv::normalize(hist, hist, 0, 1, cv::NORM_MINMAX, -1, cv::Mat());
-	}
-    if (!hist.empty() && !m_regionEmbedding.m_hist.empty())
-	{
-#if (((CV_VERSION_MAJOR == 4) && (CV_VERSION_MINOR < 1)) || (CV_VERSION_MAJOR == 3))
-		res = static_cast<track_t>(cv::compareHist(hist, m_regionEmbedding.m_hist, CV_COMP_BHATTACHARYYA));
-        //res = 1.f - static_cast<track_t>(cv::compareHist(hist, m_regionEmbedding.m_hist, CV_COMP_CORREL));
-#else
-        res = static_cast<track_t>(cv::compareHist(hist, m_regionEmbedding.m_hist, cv::HISTCMP_BHATTACHARYYA));
-#endif
-	}
-	return res;
+    return m_embeddingsGallery.CosineDist(embedding.m_embedding);
 }
 
 ///
 /// \brief CTrack::Update
+/// Kalman filter must be predicted for the current frame before: CTracker predicts all tracks at once with TKalmanFilter::PredictBatch
 /// \param region
 /// \param dataCorrect
 /// \param max_trace_length
 /// \param prevFrame
 /// \param currFrame
+/// \param staticFrame - copy of currFrame for the tracks which become static
 /// \param trajLen
 ///
 void CTrack::Update(const CRegion& region,
@@ -181,6 +169,7 @@ void CTrack::Update(const CRegion& region,
                     size_t max_trace_length,
                     cv::UMat prevFrame,
                     cv::UMat currFrame,
+                    SharedFrame& staticFrame,
                     int trajLen)
 {
     if (m_filterObjectSize) // Kalman filter for object coordinates and size
@@ -188,6 +177,9 @@ void CTrack::Update(const CRegion& region,
     else // Kalman filter only for object center
         PointUpdate(region.m_rrect.center, region.m_rrect.size, dataCorrect, currFrame.size());
 
+    // Circular buffer with the fixed capacity: new point is added before trimming
+    m_trace.Reserve(max_trace_length + 1);
+
     if (dataCorrect)
     {
         //std::cout << m_lastRegion.m_brect << " - " << region.m_brect << std::endl;
@@ -195,7 +187,7 @@ void CTrack::Update(const CRegion& region,
         m_lastRegion = region;
         m_trace.push_back(m_predictionPoint, region.m_rrect.center);
 
-        CheckStatic(trajLen, currFrame, region);
+        CheckStatic(trajLen, staticFrame, region);
     }
     else
     {
@@ -208,12 +200,14 @@ void CTrack::Update(const CRegion& region,
 
 ///
 /// \brief CTrack::Update
+/// Kalman filter must be predicted for the current frame before: CTracker predicts all tracks at once with TKalmanFilter::PredictBatch
 /// \param region
 /// \param regionEmbedding
 /// \param dataCorrect
 /// \param max_trace_length
 /// \param prevFrame
 /// \param currFrame
+/// \param staticFrame - copy of currFrame for the tracks which become static
 /// \param trajLen
 ///
 void CTrack::Update(const CRegion& region,
@@ -222,15 +216,21 @@ void CTrack::Update(const CRegion& region,
                     size_t max_trace_length,
                     cv::UMat prevFrame,
                     cv::UMat currFrame,
+                    SharedFrame& staticFrame,
                     int trajLen)
 {
     m_regionEmbedding = regionEmbedding;
+    if (dataCorrect)
+        m_embeddingsGallery.Add(regionEmbedding.m_embedding);
 
     if (m_filterObjectSize) // Kalman filter for object coordinates and size
         RectUpdate(region, dataCorrect, prevFrame, currFrame);
     else // Kalman filter only for object center
         PointUpdate(region.m_rrect.center, region.m_rrect.size, dataCorrect, currFrame.size());
 
+    // Circular buffer with the fixed capacity: new point is added before trimming
+    m_trace.Reserve(max_trace_length + 1);
+
     if (dataCorrect)
     {
         //std::cout << m_lastRegion.m_brect << " - " << region.m_brect << std::endl;
@@ -238,7 +238,7 @@ void CTrack::Update(const CRegion& region,
         m_lastRegion = region;
         m_trace.push_back(m_predictionPoint, m_lastRegion.m_rrect.center);
 
-        CheckStatic(trajLen, currFrame, region);
+        CheckStatic(trajLen, staticFrame, region);
     }
     else
     {
@@ -277,14 +277,60 @@ bool CTrack::IsOutOfTheFrame() const
 	return m_outOfTheFrame;
 }
 
+///
+/// \brief CTrack::IsPrevFrameNeeded
+/// \return true if the external tracker can be initialized on the previous frame when the track will be lost
+///
+bool CTrack::IsPrevFrameNeeded() const
+{
+    if (!m_filterObjectSize || !m_staticFrame.empty())
+        return false;
+
+    switch (m_externalTrackerForLost)
+    {
+    case tracking::TrackNone:
+        return false;
+
+    case tracking::TrackKCF:
+    case tracking::TrackMIL:
+    case tracking::TrackMedianFlow:
+    case tracking::TrackGOTURN:
+    case tracking::TrackMOSSE:
+    case tracking::TrackCSRT:
+#ifdef USE_OCV_KCF
+        return !m_tracker || m_tracker.empty();
+#else
+        return false;
+#endif
+
+    case tracking::TrackDAT:
+    case tracking::TrackSTAPLE:
+    case tracking::TrackLDES:
+        return !m_VOTTracker;
+    }
+    return false;
+}
+
 ///
 cv::RotatedRect CTrack::CalcPredictionEllipse(cv::Size_<track_t> minRadius) const
+{
+	return CalcPredictionEllipse(m_predictionPoint, m_kalman.GetVelocity(), m_kalman.GetPositionCov(), minRadius);
+}
+
+///
+/// \brief CTrack::CalcPredictionEllipse
+/// \param predictionPoint
+/// \param velocity
+/// \param positionCov - position covariance of the filter: the half sizes are not less than 3 sigma along the ellipse axes
+/// \param minRadius
+/// \return
+///
+cv::RotatedRect CTrack::CalcPredictionEllipse(const Point_t& predictionPoint, const cv::Vec<track_t, 2>& velocity, const cv::Matx<track_t, 2, 2>& positionCov, cv::Size_<track_t> minRadius)
 {
 	// Move ellipse to velocity
-	auto velocity = m_kalman.GetVelocity();
 	Point_t d(3.f * velocity[0], 3.f * velocity[1]);
 	
-	cv::RotatedRect rrect(m_predictionPoint, cv::Size2f(std::max(minRadius.width, fabs(d.x)), std::max(minRadius.height, fabs(d.y))), 0);
+	cv::RotatedRect rrect(predictionPoint, cv::Size2f(std::max(minRadius.width, fabs(d.x)), std::max(minRadius.height, fabs(d.y))), 0);
 
 	if (fabs(d.x) + fabs(d.y) > 4) // pix
 	{
@@ -293,8 +339,8 @@ cv::RotatedRect CTrack::CalcPredictionEllipse(cv::Size_<track_t> minRadius) cons
 			track_t l = std::min(rrect.size.width, rrect.size.height) / 3;
 
 			track_t p2_l = sqrtf(sqr(d.x) + sqr(d.y));
-			rrect.center.x = l * d.x / p2_l + m_predictionPoint.x;
-			rrect.center.y = l * d.y / p2_l + m_predictionPoint.y;
+			rrect.center.x = l * d.x / p2_l + predictionPoint.x;
+			rrect.center.y = l * d.y / p2_l + predictionPoint.y;
 
 			rrect.angle = atanf(d.y / d.x);
 		}
@@ -304,50 +350,49 @@ cv::RotatedRect CTrack::CalcPredictionEllipse(cv::Size_<track_t> minRadius) cons
 			rrect.angle = static_cast<float>(CV_PI / 2.);
 		}
 	}
+
+	// Variance along the axes u = (cos, sin) and v = (-sin, cos): for IMM it is the mixed covariance, so the area grows when the models disagree
+	const track_t cosA = cosf(rrect.angle);
+	const track_t sinA = sinf(rrect.angle);
+	const track_t varU = cosA * cosA * positionCov(0, 0) + 2 * cosA * sinA * positionCov(0, 1) + sinA * sinA * positionCov(1, 1);
+	const track_t varV = sinA * sinA * positionCov(0, 0) - 2 * cosA * sinA * positionCov(0, 1) + cosA * cosA * positionCov(1, 1);
+	rrect.size.width = std::max(rrect.size.width, 3.f * sqrtf(std::max(varU, 0.f)));
+	rrect.size.height = std::max(rrect.size.height, 3.f * sqrtf(std::max(varV, 0.f)));
 	return rrect;
 }
 
 ///
-/// \brief CTrack::IsInsideArea
-///        If result <= 1 then center of the object is inside ellipse with prediction and velocity
-/// \param pt
+/// \brief CTrack::WidthDist
+/// \param reg
 /// \return
 ///
-track_t CTrack::IsInsideArea(const Point_t& pt, const cv::RotatedRect& rrect) const
+track_t CTrack::WidthDist(const CRegion& reg) const
 {
-	Point_t pt_(pt.x - rrect.center.x, pt.y - rrect.center.y);
-	track_t r = sqrtf(sqr(pt_.x) + sqr(pt_.y));
-	track_t t = (r > 1) ? acosf(pt_.x / r) : 0;
-	track_t t_ = t - rrect.angle;
-	Point_t pt_rotated(r * cosf(t_), r * sinf(t_));
-
-	return sqr(pt_rotated.x) / sqr(rrect.size.width) + sqr(pt_rotated.y) / sqr(rrect.size.height);
+    return SizeRatio(m_lastRegion.m_rrect.size.width, reg.m_rrect.size.width);
 }
 
 ///
-/// \brief CTrack::WidthDist
+/// \brief CTrack::HeightDist
 /// \param reg
 /// \return
 ///
-track_t CTrack::WidthDist(const CRegion& reg) const
+track_t CTrack::HeightDist(const CRegion& reg) const
 {
-    if (m_lastRegion.m_rrect.size.width < reg.m_rrect.size.width)
-        return m_lastRegion.m_rrect.size.width / reg.m_rrect.size.width;
-    else
-        return reg.m_rrect.size.width / m_lastRegion.m_rrect.size.width;
+    return SizeRatio(m_lastRegion.m_rrect.size.height, reg.m_rrect.size.height);
 }
 
 ///
-/// \brief CTrack::HeightDist
-/// \param reg
+/// \brief CTrack::SizeRatio
+/// \param size1
+/// \param size2
 /// \return
 ///
-track_t CTrack::HeightDist(const CRegion& reg) const
+track_t CTrack::SizeRatio(track_t size1, track_t size2)
 {
-    if (m_lastRegion.m_rrect.size.height < reg.m_rrect.size.height)
-        return m_lastRegion.m_rrect.size.height / reg.m_rrect.size.height;
+    if (size1 < size2)
+        return size1 / size2;
     else
-        return reg.m_rrect.size.height / m_lastRegion.m_rrect.size.height;
+        return size2 / size1;
 }
 
 ///
@@ -355,9 +400,15 @@ track_t CTrack::HeightDist(const CRegion& reg) const
 /// \param trajLen
 /// \return
 ///
-bool CTrack::CheckStatic(int trajLen, cv::UMat currFrame, const CRegion& region)
+bool CTrack::CheckStatic(int trajLen, SharedFrame& staticFrame, const CRegion& region)
 {
-    if (!trajLen || static_cast<int>(m_trace.size()) < trajLen)
+    m_trace.SetRegressionWindow(static_cast<size_t>(std::max(0, trajLen)));
+
+    track_t kx = 0;
+    track_t bx = 0;
+    track_t ky = 0;
+    track_t by = 0;
+    if (!trajLen || !m_trace.GetLinRegress(kx, bx, ky, by))
     {
         m_isStatic = false;
         m_staticFrames = 0;
@@ -365,18 +416,13 @@ bool CTrack::CheckStatic(int trajLen, cv::UMat currFrame, const CRegion& region)
     }
     else
     {
-        track_t kx = 0;
-        track_t bx = 0;
-        track_t ky = 0;
-        track_t by = 0;
-        get_lin_regress_params(m_trace, m_trace.size() - trajLen, m_trace.size(), kx, bx, ky, by);
         track_t speed = sqrt(sqr(kx * trajLen) + sqr(ky * trajLen));
         const track_t speedThresh = 10;
         if (speed < speedThresh)
         {
             if (!m_isStatic)
             {
-                m_staticFrame = currFrame.clone();
+                m_staticFrame = staticFrame.Get();
                 m_staticRect = region.m_brect;
 #if 0
 #ifndef SILENT_WORK
@@ -434,32 +480,101 @@ const CRegion& CTrack::LastRegion() const
     return m_lastRegion;
 }
 
+///
+/// \brief CTrack::GetID
+/// \return
+///
+size_t CTrack::GetID() const
+{
+    return m_trackID;
+}
+
 ///
 /// \brief CTrack::ConstructObject
 /// \return
 ///
 TrackingObject CTrack::ConstructObject() const
 {
-    return TrackingObject(GetLastRect(), m_trackID, m_trace, IsStatic(), IsOutOfTheFrame(),
+    return TrackingObject(GetLastRect(), m_trackID, m_trace.View(), IsStatic(), IsOutOfTheFrame(),
                           m_lastRegion.m_type, m_lastRegion.m_confidence, m_kalman.GetVelocity());
 }
 
 ///
-/// \brief CTrack::SkippedFrames
+/// \brief CTrack::RefreshObject
+/// Update the object constructed by ConstructObject with the current track state, the trajectory view is always refreshed
+/// \param object
+/// \return true if the rectangle, velocity, type, confidence, static or out of the frame state was changed
+///
+bool CTrack::RefreshObject(TrackingObject& object) const
+{
+    object.m_trace = m_trace.View();
+
+    const cv::RotatedRect rrect = GetLastRect();
+    const cv::Vec<track_t, 2> velocity = m_kalman.GetVelocity();
+    const bool isStatic = IsStatic();
+    const bool outOfTheFrame = IsOutOfTheFrame();
+
+    const bool changed = rrect.center.x != object.m_rrect.center.x || rrect.center.y != object.m_rrect.center.y ||
+            rrect.size.width != object.m_rrect.size.width || rrect.size.height != object.m_rrect.size.height ||
+            rrect.angle != object.m_rrect.angle ||
+            velocity[0] != object.m_velocity[0] || velocity[1] != object.m_velocity[1] ||
+            m_lastRegion.m_type != object.m_type || m_lastRegion.m_confidence != object.m_confidence ||
+            isStatic != object.m_isStatic || outOfTheFrame != object.m_outOfTheFrame;
+    if (changed)
+    {
+        object.m_rrect = rrect;
+        object.m_velocity = velocity;
+        object.m_type = m_lastRegion.m_type;
+        object.m_confidence = m_lastRegion.m_confidence;
+        object.m_isStatic = isStatic;
+        object.m_outOfTheFrame = outOfTheFrame;
+    }
+    return changed;
+}
+
+///
+/// \brief CTrack::PredictionPoint
+/// \return
+///
+const Point_t& CTrack::PredictionPoint() const
+{
+    return m_predictionPoint;
+}
+
+///
+/// \brief CTrack::GetVelocity
 /// \return
 ///
-size_t CTrack::SkippedFrames() const
+cv::Vec<track_t, 2> CTrack::GetVelocity() const
 {
-    return m_skippedFrames;
+    return m_kalman.GetVelocity();
 }
 
 ///
-/// \brief CTrack::SkippedFrames
+/// \brief CTrack::GetPositionCov
 /// \return
 ///
-size_t& CTrack::SkippedFrames()
+cv::Matx<track_t, 2, 2> CTrack::GetPositionCov() const
 {
-    return m_skippedFrames;
+    return m_kalman.GetPositionCov();
+}
+
+///
+/// \brief CTrack::SetDeltaTime
+/// \param deltaTime - Kalman filter time step for the next update
+///
+void CTrack::SetDeltaTime(track_t deltaTime)
+{
+    m_kalman.SetDeltaTime(deltaTime);
+}
+
+///
+/// \brief CTrack::Kalman
+/// \return Kalman filter of the track for the batched prediction
+///
+TKalmanFilter& CTrack::Kalman()
+{
+    return m_kalman;
 }
 
 ///
@@ -474,8 +589,6 @@ void CTrack::RectUpdate(const CRegion& region,
                         cv::UMat prevFrame,
                         cv::UMat currFrame)
 {
-    m_kalman.GetRectPrediction();
-
     bool recalcPrediction = true;
 
     auto Clamp = [](int& v, int& size, int hi) -> int
@@ -895,8 +1008,6 @@ void CTrack::PointUpdate(const Point_t& pt,
                          bool dataCorrect,
                          const cv::Size& frameSize)
 {
-    m_kalman.GetPointPrediction();
-
     m_predictionPoint = m_kalman.Update(pt, dataCorrect);
 
     if (dataCorrect)
@@ -4,6 +4,8 @@
 #include <deque>
 #include <memory>
 #include <array>
+#include <algorithm>
+#include <mutex>
 
 #ifdef USE_OCV_KCF
 #include <opencv2/tracking.hpp>
@@ -12,6 +14,7 @@
 #include "defines.h"
 #include "object_types.h"
 #include "Kalman.h"
+#include "EmbeddingsGallery.h"
 #include "VOTTracker.hpp"
 
 ///
@@ -70,17 +73,22 @@ struct TrajectoryPoint
 };
 
 ///
-/// \brief The Trace class
+/// \brief The TraceView class
+/// Read only trajectory: copy only shares the points buffer with the track, the track copies it on the next change (copy on write)
 ///
-class Trace
+class TraceView
 {
 public:
 	///
-	Trace() = default;
+	TraceView() = default;
 	///
-    Trace(const Trace&) = default;
-    ///
-    Trace(Trace&&) = default;
+	TraceView(const TraceView&) = default;
+	///
+	TraceView(TraceView&&) = default;
+	///
+	TraceView& operator=(const TraceView&) = default;
+	///
+	TraceView& operator=(TraceView&&) = default;
 
     ///
     /// \brief operator []
@@ -89,36 +97,97 @@ public:
     ///
     const Point_t& operator[](size_t i) const
     {
-        return m_trace[i].m_prediction;
+        return at(i).m_prediction;
     }
 
     ///
-    /// \brief operator []
+    /// \brief at
     /// \param i
     /// \return
     ///
-    Point_t& operator[](size_t i)
+    const TrajectoryPoint& at(size_t i) const
     {
-        return m_trace[i].m_prediction;
+        return m_buffer->m_points[m_buffer->Index(i)];
     }
 
     ///
-    /// \brief at
-    /// \param i
+    /// \brief size
     /// \return
     ///
-    const TrajectoryPoint& at(size_t i) const
+    size_t size() const
     {
-        return m_trace[i];
+        return m_buffer ? m_buffer->m_size : 0;
     }
 
     ///
-    /// \brief size
+    /// \brief GetRawCount
+    /// \param lastPeriod
     /// \return
     ///
-    size_t size() const
+    size_t GetRawCount(size_t lastPeriod) const
+    {
+        size_t res = 0;
+
+        const size_t traceSize = size();
+        size_t i = 0;
+        if (lastPeriod < traceSize)
+            i = traceSize - lastPeriod;
+
+        for (; i < traceSize; ++i)
+        {
+            if (at(i).m_hasRaw)
+                ++res;
+        }
+
+        return res;
+    }
+
+protected:
+    ///
+    /// \brief The Buffer struct
+    /// Circular buffer: m_size points from m_head, capacity is m_points.size()
+    ///
+    struct Buffer
+    {
+        std::vector<TrajectoryPoint> m_points;
+        size_t m_head = 0;
+        size_t m_size = 0;
+
+        size_t Index(size_t i) const
+        {
+            i += m_head;
+            return (i < m_points.size()) ? i : (i - m_points.size());
+        }
+    };
+    std::shared_ptr<Buffer> m_buffer;
+};
+
+///
+/// \brief The Trace class
+/// Trajectory of the track in the circular buffer: O(1) push_back and pop_front
+///
+class Trace : public TraceView
+{
+public:
+	///
+	Trace() = default;
+	///
+    Trace(const Trace&) = default;
+    ///
+    Trace(Trace&&) = default;
+
+    using TraceView::operator[];
+
+    ///
+    /// \brief operator []
+    /// \param i
+    /// \return
+    ///
+    Point_t& operator[](size_t i)
     {
-        return m_trace.size();
+        Detach(size());
+        m_regression.m_valid = false;
+        return m_buffer->m_points[m_buffer->Index(i)].m_prediction;
     }
 
     ///
@@ -127,11 +196,13 @@ public:
     ///
     void push_back(const Point_t& prediction)
     {
-        m_trace.emplace_back(prediction);
+        RegressionPush(prediction);
+        Append() = TrajectoryPoint(prediction);
     }
     void push_back(const Point_t& prediction, const Point_t& raw)
     {
-        m_trace.emplace_back(prediction, raw);
+        RegressionPush(prediction);
+        Append() = TrajectoryPoint(prediction, raw);
     }
 
     ///
@@ -140,32 +211,20 @@ public:
     ///
     void pop_front(size_t count)
     {
-        if (count < size())
-            m_trace.erase(m_trace.begin(), m_trace.begin() + count);
+        if (!count || !m_buffer)
+            return;
+        RegressionPop(count);
+        Detach(size());
+        if (count < m_buffer->m_size)
+        {
+            m_buffer->m_head = m_buffer->Index(count);
+            m_buffer->m_size -= count;
+        }
         else
-            m_trace.clear();
-    }
-
-    ///
-    /// \brief GetRawCount
-    /// \param lastPeriod
-    /// \return
-    ///
-    size_t GetRawCount(size_t lastPeriod) const
-    {
-        size_t res = 0;
-
-        size_t i = 0;
-        if (lastPeriod < m_trace.size())
-            i = m_trace.size() - lastPeriod;
-
-        for (; i < m_trace.size(); ++i)
         {
-            if (m_trace[i].m_hasRaw)
-                ++res;
+            m_buffer->m_head = 0;
+            m_buffer->m_size = 0;
         }
-
-        return res;
     }
 
 	///
@@ -175,11 +234,199 @@ public:
 	///
 	void Reserve(size_t capacity)
 	{
-		m_trace.reserve(capacity);
+		Detach(capacity);
 	}
 
+    ///
+    /// \brief View
+    /// \return Read only trajectory without copying of the points
+    ///
+    TraceView View() const
+    {
+        return *this;
+    }
+
+    ///
+    /// \brief SetRegressionWindow
+    /// Linear regression sums for the last window points are updated in O(1) on every push_back and pop_front
+    /// \param window - 0 disables the sums
+    ///
+    void SetRegressionWindow(size_t window)
+    {
+        if (window != m_regression.m_window)
+        {
+            m_regression.m_window = window;
+            RecalcRegression();
+        }
+    }
+
+    ///
+    /// \brief GetLinRegress
+    /// The same result as get_lin_regress_params(trace, size() - window, size(), kx, bx, ky, by) in amortized O(1)
+    /// \param kx
+    /// \param bx
+    /// \param ky
+    /// \param by
+    /// \return false if the trace is shorter than the regression window
+    ///
+    template<typename T>
+    bool GetLinRegress(T& kx, T& bx, T& ky, T& by)
+    {
+        if (!m_regression.m_valid)
+            RecalcRegression();
+
+        const size_t count = m_regression.m_count;
+        if (count < 2 || count < m_regression.m_window)
+            return false;
+
+        // Indexes in the window are 0..count-1, the intercept is shifted to the trace indexes
+        const double n = static_cast<double>(count);
+        const double m1 = n * (n - 1) / 2;
+        const double m2 = (n - 1) * n * (2 * n - 1) / 6;
+        const double det_1 = 1 / (n * m2 - m1 * m1);
+        const double start = static_cast<double>(size() - count);
+
+        const double kxd = det_1 * (n * m_regression.m_sumIX - m1 * m_regression.m_sumX);
+        const double kyd = det_1 * (n * m_regression.m_sumIY - m1 * m_regression.m_sumY);
+        kx = static_cast<T>(kxd);
+        ky = static_cast<T>(kyd);
+        bx = static_cast<T>(det_1 * (m2 * m_regression.m_sumX - m1 * m_regression.m_sumIX) - kxd * start);
+        by = static_cast<T>(det_1 * (m2 * m_regression.m_sumY - m1 * m_regression.m_sumIY) - kyd * start);
+        return true;
+    }
+
 private:
-    std::vector<TrajectoryPoint> m_trace;
+    ///
+    /// \brief The RegressionSums struct
+    /// Sums of the last m_count points and their indexes in the window.
+    /// The sliding updates round in double: the drift is negligible for the frame size coordinates,
+    /// but the sums are recalculated after every m_window slides so it can't accumulate on the long tracks
+    ///
+    struct RegressionSums
+    {
+        size_t m_window = 0;
+        size_t m_count = 0;    // min(size(), m_window)
+        size_t m_slides = 0;   // Sliding updates after the last recalculation
+        double m_sumX = 0;
+        double m_sumY = 0;
+        double m_sumIX = 0;
+        double m_sumIY = 0;
+        bool m_valid = true;
+    };
+    RegressionSums m_regression;
+
+    ///
+    /// \brief RecalcRegression
+    ///
+    void RecalcRegression()
+    {
+        m_regression.m_count = std::min(size(), m_regression.m_window);
+        m_regression.m_sumX = 0;
+        m_regression.m_sumY = 0;
+        m_regression.m_sumIX = 0;
+        m_regression.m_sumIY = 0;
+        m_regression.m_slides = 0;
+        const size_t start = size() - m_regression.m_count;
+        for (size_t i = 0; i < m_regression.m_count; ++i)
+        {
+            const Point_t& pt = TraceView::operator[](start + i);
+            m_regression.m_sumX += pt.x;
+            m_regression.m_sumY += pt.y;
+            m_regression.m_sumIX += static_cast<double>(i) * pt.x;
+            m_regression.m_sumIY += static_cast<double>(i) * pt.y;
+        }
+        m_regression.m_valid = true;
+    }
+
+    ///
+    /// \brief RegressionPush
+    /// New point enters the window, the oldest one leaves it if the window is full
+    /// \param pt
+    ///
+    void RegressionPush(const Point_t& pt)
+    {
+        if (!m_regression.m_window || !m_regression.m_valid)
+            return;
+
+        if (m_regression.m_count < m_regression.m_window)
+        {
+            m_regression.m_sumIX += static_cast<double>(m_regression.m_count) * pt.x;
+            m_regression.m_sumIY += static_cast<double>(m_regression.m_count) * pt.y;
+            m_regression.m_sumX += pt.x;
+            m_regression.m_sumY += pt.y;
+            ++m_regression.m_count;
+        }
+        else
+        {
+            // Indexes of the remaining points are decreased by 1
+            const Point_t& old = TraceView::operator[](size() - m_regression.m_window);
+            const double last = static_cast<double>(m_regression.m_window - 1);
+            m_regression.m_sumIX += last * pt.x - (m_regression.m_sumX - old.x);
+            m_regression.m_sumIY += last * pt.y - (m_regression.m_sumY - old.y);
+            m_regression.m_sumX += static_cast<double>(pt.x) - old.x;
+            m_regression.m_sumY += static_cast<double>(pt.y) - old.y;
+
+            // Amortized O(1): the sums are recalculated in GetLinRegress
+            if (++m_regression.m_slides >= m_regression.m_window)
+                m_regression.m_valid = false;
+        }
+    }
+
+    ///
+    /// \brief RegressionPop
+    /// Remove the points from the window if the trace becomes shorter than it
+    /// \param count - points removed from the trace begin
+    ///
+    void RegressionPop(size_t count)
+    {
+        if (!m_regression.m_window || !m_regression.m_valid)
+            return;
+
+        const size_t outside = size() - m_regression.m_count;
+        for (size_t i = outside; i < count && m_regression.m_count > 0; ++i)
+        {
+            const Point_t& old = TraceView::operator[](i);
+            m_regression.m_sumX -= old.x;
+            m_regression.m_sumY -= old.y;
+            m_regression.m_sumIX -= m_regression.m_sumX;
+            m_regression.m_sumIY -= m_regression.m_sumY;
+            --m_regression.m_count;
+        }
+    }
+
+    ///
+    /// \brief Append
+    /// \return Place for the new point
+    ///
+    TrajectoryPoint& Append()
+    {
+        Detach(size() + 1);
+        const size_t ind = m_buffer->Index(m_buffer->m_size);
+        ++m_buffer->m_size;
+        return m_buffer->m_points[ind];
+    }
+
+    ///
+    /// \brief Detach
+    /// Own the buffer with capacity not less than minCapacity: copy it if it is shared with views or too small
+    /// \param minCapacity
+    ///
+    void Detach(size_t minCapacity)
+    {
+        const size_t capacity = m_buffer ? m_buffer->m_points.size() : 0;
+        if (m_buffer && m_buffer.use_count() == 1 && capacity >= minCapacity)
+            return;
+
+        auto buffer = std::make_shared<Buffer>();
+        buffer->m_points.resize((capacity >= minCapacity) ? capacity : std::max(minCapacity, 2 * capacity));
+        const size_t traceSize = size();
+        for (size_t i = 0; i < traceSize; ++i)
+        {
+            buffer->m_points[i] = at(i);
+        }
+        buffer->m_size = traceSize;
+        m_buffer = buffer;
+    }
 };
 
 ///
@@ -187,7 +434,7 @@ private:
 ///
 struct TrackingObject
 {
-	Trace m_trace;                     // Trajectory
+	TraceView m_trace;                 // Trajectory
 	size_t m_ID = 0;                   // Objects ID
 	cv::RotatedRect m_rrect;           // Coordinates
 	cv::Vec<track_t, 2> m_velocity;    // pixels/sec
@@ -198,7 +445,7 @@ struct TrackingObject
 	mutable bool m_lastRobust = false; // saved latest robust value
 
 	///
-    TrackingObject(const cv::RotatedRect& rrect, size_t ID, const Trace& trace,
+    TrackingObject(const cv::RotatedRect& rrect, size_t ID, const TraceView& trace,
 		bool isStatic, bool outOfTheFrame, objtype_t type, float confidence, cv::Vec<track_t, 2> velocity)
 		:
         m_trace(trace), m_ID(ID), m_rrect(rrect), m_velocity(velocity), m_type(type), m_confidence(confidence), m_isStatic(isStatic), m_outOfTheFrame(outOfTheFrame)
@@ -207,6 +454,8 @@ struct TrackingObject
 
 	///
 	TrackingObject(TrackingObject&&) = default;
+	///
+	TrackingObject& operator=(TrackingObject&&) = default;
 
     ///
     /// \brief IsRobust
@@ -239,10 +488,44 @@ struct TrackingObject
 ///
 struct RegionEmbedding
 {
-    cv::Mat m_hist;
+    cv::Mat m_hist; // Square root of the L1 normalized color histogram, 1 x bins, CV_32F
+    cv::Mat m_embedding; // L2 normalized appearance embedding, 1 x features, CV_32F
 };
 
 
+///
+/// \brief The SharedFrame class
+/// Frame copy on the first request: all tracks that became static on this frame share one reference counted copy
+///
+class SharedFrame
+{
+public:
+    ///
+    /// \brief SharedFrame
+    /// \param frame - current frame, it isn't copied in constructor
+    ///
+    SharedFrame(cv::UMat frame)
+        : m_frame(frame)
+    {
+    }
+
+    ///
+    /// \brief Get
+    /// Thread safe: tracks are updated in parallel
+    /// \return
+    ///
+    cv::UMat Get()
+    {
+        std::call_once(m_copyFlag, [this]() { m_copy = m_frame.clone(); });
+        return m_copy;
+    }
+
+private:
+    cv::UMat m_frame;
+    cv::UMat m_copy;
+    std::once_flag m_copyFlag;
+};
+
 ///
 /// \brief The CTrack class
 ///
@@ -266,7 +549,8 @@ public:
            bool useAcceleration,
            size_t trackID,
            bool filterObjectSize,
-           tracking::LostTrackType externalTrackerForLost);
+           tracking::LostTrackType externalTrackerForLost,
+           size_t embeddingsGallerySize);
 
     ///
     /// \brief CalcDist
@@ -282,50 +566,53 @@ public:
     /// \return
     ///
     track_t CalcDistRect(const CRegion& reg) const;
-    ///
-    /// \brief CalcDistJaccard
-    /// Jaccard distance from 0 to 1 between object bounding rectangles on two N and N+1 frames
-    /// \param reg
-    /// \return
-    ///
-    track_t CalcDistJaccard(const CRegion& reg) const;
 	///
-	/// \brief CalcDistJaccard
+	/// \brief CalcDistHist
 	/// Distance from 0 to 1 between objects histogramms on two N and N+1 frames
-	/// \param reg
-	/// \param currFrame
+	/// \param embedding
 	/// \return
 	///
-    track_t CalcDistHist(const CRegion& reg, cv::Mat& hist, cv::UMat currFrame) const;
-
-	cv::RotatedRect CalcPredictionEllipse(cv::Size_<track_t> minRadius) const;
+    track_t CalcDistHist(const RegionEmbedding& embedding) const;
 	///
-	/// \brief IsInsideArea
-	/// Test point inside in prediction area: prediction area + object velocity
-	/// \param pt
-	/// \param minVal
+	/// \brief CalcDistFeature
+	/// Minimal cosine distance from 0 to 1 between region and the track embeddings gallery
+	/// \param embedding
 	/// \return
 	///
-	track_t IsInsideArea(const Point_t& pt, const cv::RotatedRect& rrect) const;
+    track_t CalcDistFeature(const RegionEmbedding& embedding) const;
+
+	cv::RotatedRect CalcPredictionEllipse(cv::Size_<track_t> minRadius) const;
+	static cv::RotatedRect CalcPredictionEllipse(const Point_t& predictionPoint, const cv::Vec<track_t, 2>& velocity, const cv::Matx<track_t, 2, 2>& positionCov, cv::Size_<track_t> minRadius);
     track_t WidthDist(const CRegion& reg) const;
     track_t HeightDist(const CRegion& reg) const;
+    ///
+    /// \brief SizeRatio
+    /// \return Ratio of the smaller size to the greater one
+    ///
+    static track_t SizeRatio(track_t size1, track_t size2);
 
-    void Update(const CRegion& region, bool dataCorrect, size_t max_trace_length, cv::UMat prevFrame, cv::UMat currFrame, int trajLen);
-    void Update(const CRegion& region, const RegionEmbedding& regionEmbedding, bool dataCorrect, size_t max_trace_length, cv::UMat prevFrame, cv::UMat currFrame, int trajLen);
+    void Update(const CRegion& region, bool dataCorrect, size_t max_trace_length, cv::UMat prevFrame, cv::UMat currFrame, SharedFrame& staticFrame, int trajLen);
+    void Update(const CRegion& region, const RegionEmbedding& regionEmbedding, bool dataCorrect, size_t max_trace_length, cv::UMat prevFrame, cv::UMat currFrame, SharedFrame& staticFrame, int trajLen);
 
     bool IsStatic() const;
     bool IsStaticTimeout(int framesTime) const;
 	bool IsOutOfTheFrame() const;
+    bool IsPrevFrameNeeded() const;
 
     cv::RotatedRect GetLastRect() const;
 
     const Point_t& AveragePoint() const;
     Point_t& AveragePoint();
     const CRegion& LastRegion() const;
-    size_t SkippedFrames() const;
-    size_t& SkippedFrames();
+    const Point_t& PredictionPoint() const;
+    cv::Vec<track_t, 2> GetVelocity() const;
+    cv::Matx<track_t, 2, 2> GetPositionCov() const;
+    void SetDeltaTime(track_t deltaTime);
+    TKalmanFilter& Kalman();
+    size_t GetID() const;
 
     TrackingObject ConstructObject() const;
+    bool RefreshObject(TrackingObject& object) const;
 
 private:
 	TKalmanFilter m_kalman;
@@ -335,7 +622,6 @@ private:
     Point_t m_predictionPoint;
 
     size_t m_trackID = 0;
-    size_t m_skippedFrames = 0;
 
     tracking::LostTrackType m_externalTrackerForLost;
 #ifdef USE_OCV_KCF
@@ -350,8 +636,9 @@ private:
     void PointUpdate(const Point_t& pt, const cv::Size& newObjSize, bool dataCorrect, const cv::Size& frameSize);
 
     RegionEmbedding m_regionEmbedding;
+    EmbeddingsGallery m_embeddingsGallery;
 
-    bool CheckStatic(int trajLen, cv::UMat currFrame, const CRegion& region);
+    bool CheckStatic(int trajLen, SharedFrame& staticFrame, const CRegion& region);
 	cv::UMat m_staticFrame;
 	cv::Rect m_staticRect;
     int m_staticFrames = 0;
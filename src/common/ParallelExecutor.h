@@ -0,0 +1,138 @@
+#pragma once
+#include <memory>
+#include <functional>
+#include <string>
+
+#include "defines.h"
+#include "ThreadPool.h"
+
+///
+/// \brief The ParallelExecutor class
+/// Parallel loops of the tracker and detectors: the host application can set threads count or use own scheduler with its implementation
+///
+class ParallelExecutor
+{
+public:
+    virtual ~ParallelExecutor() = default;
+
+    ///
+    /// \brief ParallelFor
+    /// \param begin
+    /// \param end
+    /// \param grain - iterations count in one task
+    /// \param func - func(i) for i in [begin, end), it can be called from different threads
+    ///
+    virtual void ParallelFor(ptrdiff_t begin, ptrdiff_t end, ptrdiff_t grain, const std::function<void(ptrdiff_t)>& func) = 0;
+};
+
+///
+/// \brief The SerialExecutor class
+///
+class SerialExecutor final : public ParallelExecutor
+{
+public:
+    void ParallelFor(ptrdiff_t begin, ptrdiff_t end, ptrdiff_t /*grain*/, const std::function<void(ptrdiff_t)>& func) override
+    {
+        for (ptrdiff_t i = begin; i < end; ++i)
+        {
+            func(i);
+        }
+    }
+};
+
+///
+/// \brief The OpenMPExecutor class
+/// Serial loop if OpenMP is disabled
+///
+class OpenMPExecutor final : public ParallelExecutor
+{
+public:
+    void ParallelFor(ptrdiff_t begin, ptrdiff_t end, ptrdiff_t grain, const std::function<void(ptrdiff_t)>& func) override
+    {
+        grain = std::max<ptrdiff_t>(grain, 1);
+#pragma omp parallel for schedule(dynamic, grain)
+        for (ptrdiff_t i = begin; i < end; ++i)
+        {
+            func(i);
+        }
+    }
+};
+
+///
+/// \brief The ThreadPoolExecutor class
+///
+class ThreadPoolExecutor final : public ParallelExecutor
+{
+public:
+    ///
+    /// \brief ThreadPoolExecutor
+    /// \param pool - it can be shared with other executors and tasks
+    ///
+    explicit ThreadPoolExecutor(std::shared_ptr<ThreadPool> pool)
+        : m_pool(pool)
+    {
+    }
+
+    void ParallelFor(ptrdiff_t begin, ptrdiff_t end, ptrdiff_t grain, const std::function<void(ptrdiff_t)>& func) override
+    {
+        m_pool->ParallelFor(begin, end, grain, func);
+    }
+
+    ///
+    /// \brief Pool
+    /// \return
+    ///
+    std::shared_ptr<ThreadPool> Pool() const
+    {
+        return m_pool;
+    }
+
+private:
+    std::shared_ptr<ThreadPool> m_pool;
+};
+
+///
+/// \brief CreateExecutor
+/// \param executorType
+/// \param threads - thread pool size, 0 - hardware concurrency
+/// \return
+///
+inline std::shared_ptr<ParallelExecutor> CreateExecutor(tracking::ExecutorType executorType, size_t threads = 0)
+{
+    switch (executorType)
+    {
+    case tracking::ExecutorOpenMP:
+        return std::make_shared<OpenMPExecutor>();
+
+    case tracking::ExecutorThreadPool:
+        return std::make_shared<ThreadPoolExecutor>(std::make_shared<ThreadPool>(threads));
+
+    case tracking::ExecutorSerial:
+        return std::make_shared<SerialExecutor>();
+    }
+    return std::make_shared<OpenMPExecutor>();
+}
+
+///
+/// \brief CreateExecutor
+/// Executor from the config: "executor" is OpenMP (default), ThreadPool or Serial, "executorThreads" is the thread pool size
+/// \param config
+/// \return nullptr if the config has no executor
+///
+inline std::shared_ptr<ParallelExecutor> CreateExecutor(const config_t& config)
+{
+    auto executor = config.find("executor");
+    if (executor == config.end())
+        return nullptr;
+
+    size_t threads = 0;
+    auto executorThreads = config.find("executorThreads");
+    if (executorThreads != config.end())
+        threads = static_cast<size_t>(std::stoul(executorThreads->second));
+
+    if (executor->second == "ThreadPool")
+        return CreateExecutor(tracking::ExecutorThreadPool, threads);
+    if (executor->second == "Serial")
+        return CreateExecutor(tracking::ExecutorSerial, threads);
+    return CreateExecutor(tracking::ExecutorOpenMP, threads);
+}
@@ -0,0 +1,294 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <exception>
+
+///
+/// \brief The ThreadPool class
+/// Work stealing pool: every worker has own tasks queue, it takes the last added task from it (LIFO) and steals the oldest one from other workers (FIFO) if its queue is empty.
+/// Tasks that are submitted from a worker thread are added to its queue, so the nested parallel loops don't create new threads
+///
+class ThreadPool
+{
+public:
+    ///
+    /// \brief ThreadPool
+    /// \param threads - workers count, 0 - hardware concurrency
+    ///
+    explicit ThreadPool(size_t threads = 0)
+    {
+        if (!threads)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        m_queues.reserve(threads);
+        for (size_t i = 0; i < threads; ++i)
+        {
+            m_queues.emplace_back(std::make_unique<TasksQueue>());
+        }
+        m_workers.reserve(threads);
+        for (size_t i = 0; i < threads; ++i)
+        {
+            m_workers.emplace_back(&ThreadPool::WorkerThread, this, i);
+        }
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ///
+    /// \brief ~ThreadPool
+    /// All submitted tasks are completed before the workers stop
+    ///
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_stop = true;
+        }
+        m_wakeCond.notify_all();
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    ///
+    /// \brief Size
+    /// \return Workers count
+    ///
+    size_t Size() const
+    {
+        return m_workers.size();
+    }
+
+    ///
+    /// \brief Submit
+    /// \param task
+    ///
+    void Submit(std::function<void()> task)
+    {
+        const WorkerInfo& worker = CurrentWorker();
+        const size_t ind = (worker.m_pool == this) ? worker.m_index : (m_nextQueue++ % m_queues.size());
+        // The counter is increased before the push, so it is never less than the real tasks count
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            ++m_pending;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_queues[ind]->m_mutex);
+            m_queues[ind]->m_tasks.emplace_back(std::move(task));
+        }
+        m_wakeCond.notify_one();
+    }
+
+    ///
+    /// \brief ParallelFor
+    /// Loop is split to the chunks of grain iterations. The calling thread processes chunks too and waits only for the chunks that are already in progress,
+    /// so it can be called from the pool tasks without deadlocks. A worker thread runs the queued tasks while it waits, other threads sleep.
+    /// The first exception from func is rethrown in the calling thread after all started chunks are finished, the not started chunks are skipped
+    /// \param begin
+    /// \param end
+    /// \param grain - iterations count in one task
+    /// \param func - func(i) for i in [begin, end)
+    ///
+    template<typename FUNC>
+    void ParallelFor(ptrdiff_t begin, ptrdiff_t end, ptrdiff_t grain, FUNC&& func)
+    {
+        if (end <= begin)
+            return;
+
+        grain = std::max<ptrdiff_t>(grain, 1);
+        const ptrdiff_t chunks = (end - begin + grain - 1) / grain;
+        if (chunks == 1)
+        {
+            for (ptrdiff_t i = begin; i < end; ++i)
+            {
+                func(i);
+            }
+            return;
+        }
+
+        // Helpers can start after the loop end: they only see that all chunks are taken
+        std::function<void(ptrdiff_t)> chunkFunc = [&](ptrdiff_t chunk)
+        {
+            const ptrdiff_t from = begin + chunk * grain;
+            const ptrdiff_t to = std::min(from + grain, end);
+            for (ptrdiff_t i = from; i < to; ++i)
+            {
+                func(i);
+            }
+        };
+        auto loop = std::make_shared<LoopState>();
+        loop->m_chunks = chunks;
+        loop->m_func = &chunkFunc;
+
+        const size_t helpers = std::min(m_workers.size(), static_cast<size_t>(chunks - 1));
+        for (size_t i = 0; i < helpers; ++i)
+        {
+            Submit([loop]() { loop->Run(); });
+        }
+        loop->Run();
+
+        const WorkerInfo& worker = CurrentWorker();
+        if (worker.m_pool == this)
+        {
+            std::function<void()> task;
+            while (!loop->Finished() && Pop(worker.m_index, task))
+            {
+                task();
+                task = nullptr;
+            }
+        }
+        std::unique_lock<std::mutex> lock(loop->m_mutex);
+        loop->m_cond.wait(lock, [&loop]() { return loop->Finished(); });
+        if (loop->m_exception)
+            std::rethrow_exception(loop->m_exception);
+    }
+
+private:
+    ///
+    /// \brief The TasksQueue struct
+    ///
+    struct TasksQueue
+    {
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+    };
+    std::vector<std::unique_ptr<TasksQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCond;
+    std::atomic<size_t> m_pending { 0 }; // Tasks in all queues
+    std::atomic<size_t> m_nextQueue { 0 };
+    bool m_stop = false;
+
+    ///
+    /// \brief The LoopState struct
+    /// Chunks of one ParallelFor are taken by the atomic counter
+    ///
+    struct LoopState
+    {
+        std::atomic<ptrdiff_t> m_next { 0 };
+        std::atomic<ptrdiff_t> m_done { 0 };
+        std::atomic<bool> m_failed { false };
+        ptrdiff_t m_chunks = 0;
+        std::function<void(ptrdiff_t)>* m_func = nullptr;
+
+        // The caller waits for the last chunk, m_exception is written under the mutex
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::exception_ptr m_exception;
+
+        bool Finished() const
+        {
+            return m_done.load(std::memory_order_acquire) >= m_chunks;
+        }
+
+        void Run()
+        {
+            for (ptrdiff_t chunk = m_next++; chunk < m_chunks; chunk = m_next++)
+            {
+                // After the exception the chunks are only counted
+                if (!m_failed.load(std::memory_order_relaxed))
+                {
+                    try
+                    {
+                        (*m_func)(chunk);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        if (!m_exception)
+                            m_exception = std::current_exception();
+                        m_failed = true;
+                    }
+                }
+                if (m_done.fetch_add(1, std::memory_order_acq_rel) + 1 == m_chunks)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_cond.notify_all();
+                }
+            }
+        }
+    };
+
+    ///
+    /// \brief The WorkerInfo struct
+    ///
+    struct WorkerInfo
+    {
+        const ThreadPool* m_pool = nullptr;
+        size_t m_index = 0;
+    };
+    static WorkerInfo& CurrentWorker()
+    {
+        static thread_local WorkerInfo worker;
+        return worker;
+    }
+
+    ///
+    /// \brief Pop
+    /// \param ind - worker index
+    /// \param task
+    /// \return true if the task was taken from the own queue or stolen
+    ///
+    bool Pop(size_t ind, std::function<void()>& task)
+    {
+        {
+            TasksQueue& queue = *m_queues[ind];
+            std::lock_guard<std::mutex> lock(queue.m_mutex);
+            if (!queue.m_tasks.empty())
+            {
+                task = std::move(queue.m_tasks.back());
+                queue.m_tasks.pop_back();
+                --m_pending;
+                return true;
+            }
+        }
+        for (size_t i = 1; i < m_queues.size(); ++i)
+        {
+            TasksQueue& queue = *m_queues[(ind + i) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(queue.m_mutex);
+            if (!queue.m_tasks.empty())
+            {
+                task = std::move(queue.m_tasks.front());
+                queue.m_tasks.pop_front();
+                --m_pending;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    ///
+    /// \brief WorkerThread
+    /// \param ind
+    ///
+    void WorkerThread(size_t ind)
+    {
+        CurrentWorker() = { this, ind };
+
+        std::function<void()> task;
+        for (;;)
+        {
+            if (Pop(ind, task))
+            {
+                task();
+                task = nullptr;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeCond.wait(lock, [this]() { return m_stop || m_pending > 0; });
+            if (m_stop && m_pending == 0)
+                break;
+        }
+    }
+};
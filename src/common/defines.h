@@ -17,6 +17,65 @@ typedef cv::Point_<track_t> Point_t;
 typedef std::vector<int> assignments_t;
 typedef std::vector<track_t> distMatrix_t;
 
+///
+/// \brief The SparseDistMatrix struct
+/// Distances only for the evaluated pairs tracks (rows) -> regions (columns) in CSR format
+///
+struct SparseDistMatrix
+{
+    size_t m_rows = 0;
+    size_t m_cols = 0;
+
+    std::vector<size_t> m_rowsStart; // m_rows + 1 offsets in m_colsInd and m_dists
+    std::vector<int> m_colsInd;      // Sorted columns indexes in every row
+    std::vector<track_t> m_dists;
+
+    ///
+    /// \brief Reset
+    /// \param rows
+    /// \param cols
+    ///
+    void Reset(size_t rows, size_t cols)
+    {
+        m_rows = rows;
+        m_cols = cols;
+        m_rowsStart.clear();
+        m_rowsStart.reserve(rows + 1);
+        m_rowsStart.push_back(0);
+        m_colsInd.clear();
+        m_dists.clear();
+    }
+
+    ///
+    /// \brief Add
+    /// Add distance to the current row, columns must be added in ascending order
+    /// \param col
+    /// \param dist
+    ///
+    void Add(int col, track_t dist)
+    {
+        m_colsInd.push_back(col);
+        m_dists.push_back(dist);
+    }
+
+    ///
+    /// \brief FinishRow
+    ///
+    void FinishRow()
+    {
+        m_rowsStart.push_back(m_colsInd.size());
+    }
+
+    ///
+    /// \brief NonZeros
+    /// \return
+    ///
+    size_t NonZeros() const
+    {
+        return m_colsInd.size();
+    }
+};
+
 ///
 /// \brief config_t
 ///
@@ -110,6 +169,7 @@ enum DistType
     DistRects,     // Euclidean distance between bounding rectangles, pixels
     DistJaccard,   // Intersection over Union, IoU, [0, 1]
 	DistHist,      // Bhatacharia distance between histograms, [0, 1]
+	DistFeatureCos, // Cosine distance between appearance embeddings (ReID features), [0, 1]
 	DistsCount
 };
 
@@ -129,7 +189,8 @@ enum KalmanType
 {
     KalmanLinear,
     KalmanUnscented,
-    KalmanAugmentedUnscented
+    KalmanAugmentedUnscented,
+    KalmanIMM          // Interacting Multiple Model: mixing of the linear constant velocity and constant acceleration models
 };
 
 ///
@@ -138,7 +199,9 @@ enum KalmanType
 enum MatchType
 {
     MatchHungrian,
-    MatchBipart
+    MatchBipart,
+    MatchSparseJV,
+    MatchLAPJV
 };
 
 ///
@@ -157,4 +220,15 @@ enum LostTrackType
     TrackSTAPLE,
     TrackLDES
 };
+
+///
+/// \brief The ExecutorType enum
+/// Parallel loops of the tracker and detectors
+///
+enum ExecutorType
+{
+    ExecutorOpenMP,
+    ExecutorThreadPool,
+    ExecutorSerial
+};
 }
@@ -0,0 +1,189 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+///
+/// \brief The RectsSoA struct
+/// Rectangles in the structure of arrays (x1, y1, x2, y2, area) for the batched IoU
+///
+struct RectsSoA
+{
+    std::vector<float> m_x1;
+    std::vector<float> m_y1;
+    std::vector<float> m_x2;
+    std::vector<float> m_y2;
+    std::vector<float> m_area;
+
+    ///
+    /// \brief Clear
+    /// \param capacity
+    ///
+    void Clear(size_t capacity = 0)
+    {
+        for (auto* arr : { &m_x1, &m_y1, &m_x2, &m_y2, &m_area })
+        {
+            arr->clear();
+            arr->reserve(capacity);
+        }
+    }
+
+    ///
+    /// \brief Add
+    /// \param rect
+    ///
+    void Add(const cv::Rect& rect)
+    {
+        m_x1.push_back(static_cast<float>(rect.x));
+        m_y1.push_back(static_cast<float>(rect.y));
+        m_x2.push_back(static_cast<float>(rect.x + rect.width));
+        m_y2.push_back(static_cast<float>(rect.y + rect.height));
+        m_area.push_back(static_cast<float>(rect.area()));
+    }
+
+    ///
+    /// \brief Rect
+    /// \param i
+    /// \return Source rectangle: integer coordinates are exact in float while their absolute values are less than 2^24
+    ///
+    cv::Rect Rect(size_t i) const
+    {
+        return cv::Rect(cv::Point(static_cast<int>(m_x1[i]), static_cast<int>(m_y1[i])),
+                        cv::Point(static_cast<int>(m_x2[i]), static_cast<int>(m_y2[i])));
+    }
+
+    ///
+    /// \brief Move
+    /// \param from
+    /// \param to
+    ///
+    void Move(size_t from, size_t to)
+    {
+        m_x1[to] = m_x1[from];
+        m_y1[to] = m_y1[from];
+        m_x2[to] = m_x2[from];
+        m_y2[to] = m_y2[from];
+        m_area[to] = m_area[from];
+    }
+
+    ///
+    /// \brief Size
+    /// \return
+    ///
+    size_t Size() const
+    {
+        return m_x1.size();
+    }
+};
+
+///
+/// \brief CalcIoU
+/// Intersection over union of one rectangle with the rectangles subset without branches: AVX2 or SSE with scalar tail.
+/// Coordinates and areas are exact in float while they are less than 2^24 (rectangles up to 4096x4096 with the union area up to 2^24),
+/// then the result is the same as (rect1 & rect2).area() / union. Bigger areas are rounded with the float relative error 6e-8
+/// \param rect
+/// \param rects
+/// \param inds - indexes in rects or nullptr for count rectangles from the first
+/// \param count - size of inds and res
+/// \param res - IoU from 0 to 1
+/// \param first - index of the first rectangle if inds is nullptr
+///
+inline void CalcIoU(const cv::Rect& rect, const RectsSoA& rects, const int* inds, size_t count, float* res, size_t first = 0)
+{
+    const float x1 = static_cast<float>(rect.x);
+    const float y1 = static_cast<float>(rect.y);
+    const float x2 = static_cast<float>(rect.x + rect.width);
+    const float y2 = static_cast<float>(rect.y + rect.height);
+    const float area = static_cast<float>(rect.area());
+
+    const float* rx1 = rects.m_x1.data();
+    const float* ry1 = rects.m_y1.data();
+    const float* rx2 = rects.m_x2.data();
+    const float* ry2 = rects.m_y2.data();
+    const float* rarea = rects.m_area.data();
+
+    size_t i = 0;
+#if defined(__AVX2__)
+    {
+        const __m256 vx1 = _mm256_set1_ps(x1);
+        const __m256 vy1 = _mm256_set1_ps(y1);
+        const __m256 vx2 = _mm256_set1_ps(x2);
+        const __m256 vy2 = _mm256_set1_ps(y2);
+        const __m256 varea = _mm256_set1_ps(area);
+        const __m256 zero = _mm256_setzero_ps();
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 bx1, by1, bx2, by2, barea;
+            if (inds)
+            {
+                const __m256i ind = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inds + i));
+                bx1 = _mm256_i32gather_ps(rx1, ind, 4);
+                by1 = _mm256_i32gather_ps(ry1, ind, 4);
+                bx2 = _mm256_i32gather_ps(rx2, ind, 4);
+                by2 = _mm256_i32gather_ps(ry2, ind, 4);
+                barea = _mm256_i32gather_ps(rarea, ind, 4);
+            }
+            else
+            {
+                bx1 = _mm256_loadu_ps(rx1 + first + i);
+                by1 = _mm256_loadu_ps(ry1 + first + i);
+                bx2 = _mm256_loadu_ps(rx2 + first + i);
+                by2 = _mm256_loadu_ps(ry2 + first + i);
+                barea = _mm256_loadu_ps(rarea + first + i);
+            }
+            const __m256 w = _mm256_max_ps(_mm256_sub_ps(_mm256_min_ps(vx2, bx2), _mm256_max_ps(vx1, bx1)), zero);
+            const __m256 h = _mm256_max_ps(_mm256_sub_ps(_mm256_min_ps(vy2, by2), _mm256_max_ps(vy1, by1)), zero);
+            const __m256 intArea = _mm256_mul_ps(w, h);
+            const __m256 unionArea = _mm256_sub_ps(_mm256_add_ps(varea, barea), intArea);
+            _mm256_storeu_ps(res + i, _mm256_div_ps(intArea, unionArea));
+        }
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    {
+        const __m128 vx1 = _mm_set1_ps(x1);
+        const __m128 vy1 = _mm_set1_ps(y1);
+        const __m128 vx2 = _mm_set1_ps(x2);
+        const __m128 vy2 = _mm_set1_ps(y2);
+        const __m128 varea = _mm_set1_ps(area);
+        const __m128 zero = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 bx1, by1, bx2, by2, barea;
+            if (inds)
+            {
+                const int* ind = inds + i;
+                bx1 = _mm_setr_ps(rx1[ind[0]], rx1[ind[1]], rx1[ind[2]], rx1[ind[3]]);
+                by1 = _mm_setr_ps(ry1[ind[0]], ry1[ind[1]], ry1[ind[2]], ry1[ind[3]]);
+                bx2 = _mm_setr_ps(rx2[ind[0]], rx2[ind[1]], rx2[ind[2]], rx2[ind[3]]);
+                by2 = _mm_setr_ps(ry2[ind[0]], ry2[ind[1]], ry2[ind[2]], ry2[ind[3]]);
+                barea = _mm_setr_ps(rarea[ind[0]], rarea[ind[1]], rarea[ind[2]], rarea[ind[3]]);
+            }
+            else
+            {
+                bx1 = _mm_loadu_ps(rx1 + first + i);
+                by1 = _mm_loadu_ps(ry1 + first + i);
+                bx2 = _mm_loadu_ps(rx2 + first + i);
+                by2 = _mm_loadu_ps(ry2 + first + i);
+                barea = _mm_loadu_ps(rarea + first + i);
+            }
+            const __m128 w = _mm_max_ps(_mm_sub_ps(_mm_min_ps(vx2, bx2), _mm_max_ps(vx1, bx1)), zero);
+            const __m128 h = _mm_max_ps(_mm_sub_ps(_mm_min_ps(vy2, by2), _mm_max_ps(vy1, by1)), zero);
+            const __m128 intArea = _mm_mul_ps(w, h);
+            const __m128 unionArea = _mm_sub_ps(_mm_add_ps(varea, barea), intArea);
+            _mm_storeu_ps(res + i, _mm_div_ps(intArea, unionArea));
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        const size_t j = inds ? static_cast<size_t>(inds[i]) : (first + i);
+        const float w = std::max(std::min(x2, rx2[j]) - std::max(x1, rx1[j]), 0.f);
+        const float h = std::max(std::min(y2, ry2[j]) - std::max(y1, ry1[j]), 0.f);
+        const float intArea = w * h;
+        res[i] = intArea / (area + rarea[j] - intArea);
+    }
+}
@@ -1,6 +1,76 @@
 #pragma once
 #include <opencv2/opencv.hpp>
 #include <assert.h>
+#include <numeric>
+#include "iou.h"
+
+/**
+ * @brief nmsOrder
+ * Indexes sorted by descending keys, equal keys are ordered by descending indexes (the same as the multimap from the end)
+ * @param keys
+ * @return
+ */
+template<typename KEY>
+inline std::vector<int> nmsOrder(const std::vector<KEY>& keys)
+{
+    std::vector<int> order(keys.size());
+    std::iota(std::begin(order), std::end(order), 0);
+    std::sort(std::begin(order), std::end(order), [&keys](int i1, int i2)
+    {
+        return (keys[i1] > keys[i2]) || (!(keys[i2] > keys[i1]) && i1 > i2);
+    });
+    return order;
+}
+
+/**
+ * @brief nmsSorted
+ * Greedy suppression of the sorted boxes: overlaps of the picked box with all remaining boxes are calculated at once,
+ * the boxes that pass the keep mask are compacted to the flat arrays, so suppressed boxes are never compared again
+ * @param rects - boxes in the sorted order
+ * @param order - source indexes in the sorted order
+ * @param thresh
+ * @param OnPick - called with the source index of the picked box and the source indexes of the boxes suppressed by it in ascending order
+ */
+template<typename PICK_FUNC>
+inline void nmsSorted(RectsSoA& rects,
+                      std::vector<int>& order,
+                      float thresh,
+                      PICK_FUNC OnPick)
+{
+    size_t count = order.size();
+    std::vector<float> overlaps(count);
+    std::vector<int> suppressed;
+    suppressed.reserve(count);
+
+    for (size_t head = 0; head < count; ++head)
+    {
+        const size_t first = head + 1;
+        const size_t rest = count - first;
+        CalcIoU(rects.Rect(head), rects, nullptr, rest, overlaps.data(), first);
+
+        // suppressed boxes from the lowest priority
+        suppressed.clear();
+        for (size_t k = rest; k-- > 0;)
+        {
+            if (overlaps[k] > thresh)
+                suppressed.push_back(order[first + k]);
+        }
+        OnPick(order[head], suppressed);
+
+        if (suppressed.empty())
+            continue;
+
+        // keep mask: compaction without branches
+        size_t alive = first;
+        for (size_t k = 0; k < rest; ++k)
+        {
+            rects.Move(first + k, alive);
+            order[alive] = order[first + k];
+            alive += !(overlaps[k] > thresh);
+        }
+        count = alive;
+    }
+}
 
 /**
  * @brief nms
@@ -22,46 +92,25 @@ inline void nms(const std::vector<cv::Rect>& srcRects,
         return;
 
     // Sort the bounding boxes by the bottom - right y - coordinate of the bounding box
-    std::multimap<int, size_t> idxs;
+    std::vector<int> keys(size);
     for (size_t i = 0; i < size; ++i)
     {
-        idxs.emplace(srcRects[i].br().y, i);
+        keys[i] = srcRects[i].br().y;
     }
+    std::vector<int> order = nmsOrder(keys);
 
-    // keep looping while some indexes still remain in the indexes list
-    while (idxs.size() > 0)
+    RectsSoA rects;
+    rects.Clear(size);
+    for (int i : order)
     {
-        // grab the last rectangle
-        auto lastElem = --std::end(idxs);
-        const cv::Rect& rect1 = srcRects[lastElem->second];
-
-        int neigborsCount = 0;
-
-        idxs.erase(lastElem);
-
-        for (auto pos = std::begin(idxs); pos != std::end(idxs); )
-        {
-            // grab the current rectangle
-            const cv::Rect& rect2 = srcRects[pos->second];
-
-			float intArea = static_cast<float>((rect1 & rect2).area());
-			float unionArea = static_cast<float>(rect1.area() + rect2.area() - intArea);
-            float overlap = intArea / unionArea;
-
-            // if there is sufficient overlap, suppress the current bounding box
-            if (overlap > thresh)
-            {
-                pos = idxs.erase(pos);
-                ++neigborsCount;
-            }
-            else
-            {
-                ++pos;
-            }
-        }
-        if (neigborsCount >= neighbors)
-            resRects.push_back(rect1);
+        rects.Add(srcRects[i]);
     }
+
+    nmsSorted(rects, order, thresh, [&](int ind, const std::vector<int>& suppressed)
+    {
+        if (static_cast<int>(suppressed.size()) >= neighbors)
+            resRects.push_back(srcRects[ind]);
+    });
 }
 
 /**
@@ -89,56 +138,34 @@ inline void nms2(const std::vector<cv::Rect>& srcRects,
     assert(srcRects.size() == scores.size());
 
     // Sort the bounding boxes by the detection score
-    std::multimap<float, size_t> idxs;
-    for (size_t i = 0; i < size; ++i)
+    std::vector<int> order = nmsOrder(scores);
+
+    RectsSoA rects;
+    rects.Clear(size);
+    for (int i : order)
     {
-        idxs.emplace(scores[i], i);
+        rects.Add(srcRects[i]);
     }
 
-    // keep looping while some indexes still remain in the indexes list
-    while (idxs.size() > 0)
+    nmsSorted(rects, order, thresh, [&](int ind, const std::vector<int>& suppressed)
     {
-        // grab the last rectangle
-        auto lastElem = --std::end(idxs);
-        const cv::Rect& rect1 = srcRects[lastElem->second];
-
-        int neigborsCount = 0;
-        float scoresSum = lastElem->first;
-
-        idxs.erase(lastElem);
-
-        for (auto pos = std::begin(idxs); pos != std::end(idxs); )
+        float scoresSum = scores[ind];
+        for (int i : suppressed)
         {
-            // grab the current rectangle
-            const cv::Rect& rect2 = srcRects[pos->second];
-
-            float intArea = static_cast<float>((rect1 & rect2).area());
-            float unionArea = static_cast<float>(rect1.area() + rect2.area() - intArea);
-            float overlap = intArea / unionArea;
-
-            // if there is sufficient overlap, suppress the current bounding box
-            if (overlap > thresh)
-            {
-                scoresSum += pos->first;
-                pos = idxs.erase(pos);
-                ++neigborsCount;
-            }
-            else
-            {
-                ++pos;
-            }
+            scoresSum += scores[i];
         }
-        if (neigborsCount >= neighbors && scoresSum >= minScoresSum)
-            resRects.push_back(rect1);
-    }
+        if (static_cast<int>(suppressed.size()) >= neighbors && scoresSum >= minScoresSum)
+            resRects.push_back(srcRects[ind]);
+    });
 }
 
 
 /**
  * @brief nms3
- * Non maximum suppression with detection scores
+ * Non maximum suppression with detection scores for each object type:
+ * boxes are grouped by type, so the boxes of different types are never compared
  * @param srcRects
- * @param resRects
+ * @param resRects - in the order of the descending scores as for all types together
  * @param thresh
  * @param neighbors
  */
@@ -159,56 +186,62 @@ inline void nms3(const std::vector<OBJ>& srcRects,
         return;
 
     // Sort the bounding boxes by the detection score
-    std::multimap<float, size_t> idxs;
+    std::vector<float> scores(size);
+    std::vector<typename std::decay<decltype(GetType(srcRects[0]))>::type> types;
+    types.reserve(size);
     for (size_t i = 0; i < size; ++i)
     {
-        idxs.emplace(GetScore(srcRects[i]), i);
+        scores[i] = GetScore(srcRects[i]);
+        types.push_back(GetType(srcRects[i]));
     }
+    std::vector<int> order = nmsOrder(scores);
 
-    // keep looping while some indexes still remain in the indexes list
-    while (idxs.size() > 0)
+    // Position in the sorted order is the priority for the result
+    std::vector<int> ranks(size);
+    for (size_t i = 0; i < size; ++i)
     {
-        // grab the last rectangle
-        auto lastElem = --std::end(idxs);
-        size_t lastPos = lastElem->second;
-        const cv::Rect& rect1 = GetRect(srcRects[lastPos]);
-        auto type1 = GetType(srcRects[lastPos]);
+        ranks[order[i]] = static_cast<int>(i);
+    }
 
-        int neigborsCount = 0;
-        float scoresSum = lastElem->first;
+    // Group by type, the sorted order is kept inside the group
+    std::stable_sort(std::begin(order), std::end(order), [&types](int i1, int i2) { return types[i1] < types[i2]; });
 
-        idxs.erase(lastElem);
+    std::vector<int> picked;
+    RectsSoA rects;
+    std::vector<int> typeOrder;
+    for (size_t from = 0; from < size;)
+    {
+        size_t to = from + 1;
+        while (to < size && types[order[to]] == types[order[from]])
+        {
+            ++to;
+        }
 
-        for (auto pos = std::begin(idxs); pos != std::end(idxs); )
+        typeOrder.assign(std::begin(order) + from, std::begin(order) + to);
+        rects.Clear(typeOrder.size());
+        for (int i : typeOrder)
         {
-            // grab the current rectangle
-            auto type2 = GetType(srcRects[pos->second]);
-            if (type1 == type2)
-            {
-                const cv::Rect& rect2 = GetRect(srcRects[pos->second]);
-
-                float intArea = static_cast<float>((rect1 & rect2).area());
-                float unionArea = static_cast<float>(rect1.area() + rect2.area() - intArea);
-                float overlap = intArea / unionArea;
-
-                // if there is sufficient overlap, suppress the current bounding box
-                if (overlap > thresh)
-                {
-                    scoresSum += pos->first;
-                    pos = idxs.erase(pos);
-                    ++neigborsCount;
-                }
-                else
-                {
-                    ++pos;
-                }
-            }
-            else
+            rects.Add(GetRect(srcRects[i]));
+        }
+
+        nmsSorted(rects, typeOrder, thresh, [&](int ind, const std::vector<int>& suppressed)
+        {
+            float scoresSum = scores[ind];
+            for (int i : suppressed)
             {
-                ++pos;
+                scoresSum += scores[i];
             }
-        }
-        if (neigborsCount >= neighbors && scoresSum >= minScoresSum)
-            resRects.push_back(srcRects[lastPos]);
+            if (static_cast<int>(suppressed.size()) >= neighbors && scoresSum >= minScoresSum)
+                picked.push_back(ind);
+        });
+
+        from = to;
+    }
+
+    std::sort(std::begin(picked), std::end(picked), [&ranks](int i1, int i2) { return ranks[i1] < ranks[i2]; });
+    resRects.reserve(picked.size());
+    for (int i : picked)
+    {
+        resRects.push_back(srcRects[i]);
     }
 }
@@ -0,0 +1,68 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include "ShortPathCalculator.h"
+#include "AssignmentScene.h"
+
+///
+/// \brief BenchSolver
+/// \param solver
+/// \param scene
+/// \param repeats
+/// \param assigned
+/// \param cost
+/// \return Mean time of Solve in milliseconds
+///
+double BenchSolver(ShortPathCalculator& solver, const AssignmentScene& scene, int repeats, size_t& assigned, double& cost)
+{
+    assignments_t assignment;
+    // Warm up: the solvers keep their buffers between calls like in CTracker
+    solver.Solve(scene.m_costMatrix, scene.m_tracks, scene.m_regions, assignment, scene.m_maxPossibleCost);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i)
+    {
+        solver.Solve(scene.m_costMatrix, scene.m_tracks, scene.m_regions, assignment, scene.m_maxPossibleCost);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    cost = scene.GatedCost(assignment, assigned);
+    return std::chrono::duration<double, std::milli>(t1 - t0).count() / repeats;
+}
+
+///
+/// \brief main
+/// LAPJV vs SPHungrian vs SPBipart on the gated 1080p scenes with 50, 200 and 1000 objects
+///
+int main(int /*argc*/, char** /*argv*/)
+{
+    const size_t objectsCount[] = { 50, 200, 1000 };
+    const int repeats[] = { 200, 20, 2 };
+
+    std::cout << std::setw(8) << "objects" << std::setw(12) << "solver" << std::setw(12) << "time, ms"
+              << std::setw(10) << "assigned" << std::setw(14) << "gated cost" << std::endl;
+
+    for (size_t s = 0; s < sizeof(objectsCount) / sizeof(objectsCount[0]); ++s)
+    {
+        AssignmentScene scene;
+        scene.Generate(objectsCount[s], 12345);
+
+        SPSettings settings = { scene.m_distThres, 12 };
+        std::unique_ptr<ShortPathCalculator> solvers[] = {
+            std::make_unique<SPLAPJV>(settings),
+            std::make_unique<SPHungrian>(settings),
+            std::make_unique<SPBipart>(settings) };
+        const char* names[] = { "LAPJV", "Hungrian", "Bipart" };
+
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+        {
+            size_t assigned = 0;
+            double cost = 0;
+            double time = BenchSolver(*solvers[i], scene, repeats[s], assigned, cost);
+            std::cout << std::setw(8) << objectsCount[s] << std::setw(12) << names[i] << std::setw(12) << std::fixed << std::setprecision(3) << time
+                      << std::setw(10) << assigned << std::setw(14) << std::setprecision(3) << cost << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <random>
+#include <cmath>
+#include "defines.h"
+
+///
+/// \brief The AssignmentScene struct
+/// Synthetic gated cost matrix like in CTracker::CreateDistaceMatrix: tracks and detections on the 1080p frame,
+/// the cost of the pair is the centers distance divided by the gate radius, pairs out of the gate have the cost maxPossibleCost
+///
+struct AssignmentScene
+{
+    static constexpr int FRAME_WIDTH = 1920;
+    static constexpr int FRAME_HEIGHT = 1080;
+
+    size_t m_tracks = 0;
+    size_t m_regions = 0;
+    distMatrix_t m_costMatrix;   // m_costMatrix[track + region * m_tracks]
+    track_t m_distThres = 0.8f;
+    track_t m_maxPossibleCost = static_cast<track_t>(FRAME_WIDTH * FRAME_HEIGHT);
+
+    ///
+    /// \brief Generate
+    /// Every track is detected with the probability 0.9 and moved by up to maxShift pixels, 10% of detections are new objects
+    /// \param objects
+    /// \param seed
+    /// \param gateRadius - pixels
+    /// \param maxShift - pixels
+    ///
+    void Generate(size_t objects, unsigned int seed, float gateRadius = 50.f, float maxShift = 30.f)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> xDist(0.f, static_cast<float>(FRAME_WIDTH));
+        std::uniform_real_distribution<float> yDist(0.f, static_cast<float>(FRAME_HEIGHT));
+        std::uniform_real_distribution<float> shiftDist(-maxShift, maxShift);
+        std::uniform_real_distribution<float> probDist(0.f, 1.f);
+
+        std::vector<float> tracksX(objects);
+        std::vector<float> tracksY(objects);
+        std::vector<float> regionsX;
+        std::vector<float> regionsY;
+        regionsX.reserve(objects + objects / 10);
+        regionsY.reserve(objects + objects / 10);
+        for (size_t i = 0; i < objects; ++i)
+        {
+            tracksX[i] = xDist(gen);
+            tracksY[i] = yDist(gen);
+            if (probDist(gen) < 0.9f)
+            {
+                regionsX.push_back(tracksX[i] + shiftDist(gen));
+                regionsY.push_back(tracksY[i] + shiftDist(gen));
+            }
+        }
+        for (size_t i = 0; i < objects / 10; ++i)
+        {
+            regionsX.push_back(xDist(gen));
+            regionsY.push_back(yDist(gen));
+        }
+
+        m_tracks = objects;
+        m_regions = regionsX.size();
+        m_costMatrix.assign(m_tracks * m_regions, m_maxPossibleCost);
+        for (size_t i = 0; i < m_tracks; ++i)
+        {
+            for (size_t j = 0; j < m_regions; ++j)
+            {
+                const float dist = std::hypot(tracksX[i] - regionsX[j], tracksY[i] - regionsY[j]) / gateRadius;
+                if (dist < m_distThres)
+                    m_costMatrix[i + j * m_tracks] = dist;
+            }
+        }
+    }
+
+    ///
+    /// \brief GatedCost
+    /// \param assignment
+    /// \param assigned - number of the assigned pairs inside the gate
+    /// \return Sum of the assigned pairs costs inside the gate, every not assigned track costs m_distThres
+    ///
+    double GatedCost(const assignments_t& assignment, size_t& assigned) const
+    {
+        double cost = 0;
+        assigned = 0;
+        for (size_t i = 0; i < m_tracks; ++i)
+        {
+            const track_t dist = (assignment[i] >= 0) ? m_costMatrix[i + assignment[i] * m_tracks] : m_maxPossibleCost;
+            if (dist < m_distThres)
+            {
+                cost += dist;
+                ++assigned;
+            }
+            else
+            {
+                cost += m_distThres;
+            }
+        }
+        return cost;
+    }
+};
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "HungarianAlg/HungarianAlg.h"
+#include "AssignmentScene.h"
+
+///
+/// Global allocations counter: repeated Solve calls with the same matrix size must reuse the workspace
+///
+static std::atomic<size_t> g_allocations(0);
+
+void* operator new(std::size_t size)
+{
+    ++g_allocations;
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+///
+/// \brief main
+/// \return 0 if the repeated same-sized AssignmentProblemSolver::Solve calls don't allocate
+///
+int main(int /*argc*/, char** /*argv*/)
+{
+    const AssignmentProblemSolver::TMethod methods[] = {
+        AssignmentProblemSolver::optimal,
+        AssignmentProblemSolver::many_forbidden_assignments,
+        AssignmentProblemSolver::without_forbidden_assignments };
+    const char* names[] = { "optimal", "many_forbidden_assignments", "without_forbidden_assignments" };
+
+    int res = 0;
+    for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); ++m)
+    {
+        AssignmentScene scene;
+        scene.Generate(100, 7);
+
+        AssignmentProblemSolver solver;
+        assignments_t assignment;
+        solver.Solve(scene.m_costMatrix, scene.m_tracks, scene.m_regions, assignment, methods[m]);
+
+        // The different costs with the same matrix size
+        distMatrix_t costMatrix2 = scene.m_costMatrix;
+        for (auto& dist : costMatrix2)
+        {
+            if (dist < scene.m_distThres)
+                dist = scene.m_distThres - dist;
+        }
+
+        const size_t allocations = g_allocations;
+        for (int i = 0; i < 10; ++i)
+        {
+            solver.Solve((i % 2) ? costMatrix2 : scene.m_costMatrix, scene.m_tracks, scene.m_regions, assignment, methods[m]);
+        }
+        const size_t newAllocations = g_allocations - allocations;
+
+        std::cout << names[m] << ": " << newAllocations << " allocations in 10 repeated Solve calls" << std::endl;
+        if (newAllocations)
+            res = 1;
+    }
+    return res;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "Kalman.h"
+
+///
+/// \brief Measurement
+/// \param track
+/// \param frame
+/// \return Rectangle of the track moving in its own direction
+///
+cv::Rect Measurement(size_t track, int frame)
+{
+    const int x = static_cast<int>(track % 40) * 45 + frame * static_cast<int>(track % 7);
+    const int y = static_cast<int>(track / 40) * 80 + frame * static_cast<int>(track % 5);
+    return cv::Rect(x, y, 30, 60);
+}
+
+///
+/// \brief Correct
+/// \param filter
+/// \param filterRect
+/// \param measurement
+///
+void Correct(TKalmanFilter& filter, bool filterRect, const cv::Rect& measurement)
+{
+    if (filterRect)
+        filter.Update(measurement, true);
+    else
+        filter.Update(Point_t(static_cast<track_t>(measurement.x), static_cast<track_t>(measurement.y)), true);
+}
+
+///
+/// \brief RunFrames
+/// Predict and correct all filters for every frame, the filters are created and initialized before
+/// \param tracks
+/// \param useAcceleration
+/// \param filterRect
+/// \param frames
+/// \param batch - prediction with TKalmanFilter::PredictBatch or one call per track
+/// \return Mean time of the prediction for all tracks in microseconds
+///
+double RunFrames(size_t tracks, bool useAcceleration, bool filterRect, int frames, bool batch)
+{
+    std::vector<std::unique_ptr<TKalmanFilter>> filters;
+    std::vector<TKalmanFilter*> filtersPtrs;
+    for (size_t i = 0; i < tracks; ++i)
+    {
+        filters.push_back(std::make_unique<TKalmanFilter>(tracking::KalmanLinear, useAcceleration, filterRect, 0.2f, 0.5f));
+        filtersPtrs.push_back(filters.back().get());
+    }
+    const int initFrames = 10;
+    for (int frame = 0; frame < initFrames; ++frame)
+    {
+        TKalmanFilter::PredictBatch(filtersPtrs.data(), filtersPtrs.size());
+        for (size_t i = 0; i < tracks; ++i)
+        {
+            Correct(*filters[i], filterRect, Measurement(i, frame));
+        }
+    }
+
+    double time = 0;
+    for (int frame = initFrames; frame < initFrames + frames; ++frame)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        if (batch)
+        {
+            TKalmanFilter::PredictBatch(filtersPtrs.data(), filtersPtrs.size());
+        }
+        else
+        {
+            for (auto& filter : filters)
+            {
+                if (filterRect)
+                    filter->GetRectPrediction();
+                else
+                    filter->GetPointPrediction();
+            }
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        time += std::chrono::duration<double, std::micro>(t1 - t0).count();
+
+        for (size_t i = 0; i < tracks; ++i)
+        {
+            Correct(*filters[i], filterRect, Measurement(i, frame));
+        }
+    }
+    return time / frames;
+}
+
+///
+/// \brief main
+/// Prediction of 500 tracks: one virtual TKalmanFilter call per track vs TKalmanFilter::PredictBatch with one call per filters group
+///
+int main(int /*argc*/, char** /*argv*/)
+{
+    const size_t tracks = 500;
+    const int frames = 200;
+
+    std::cout << std::setw(12) << "model" << std::setw(16) << "per track, us" << std::setw(12) << "batch, us" << std::endl;
+
+    const char* names[] = { "CV point", "CV rect", "CA point", "CA rect" };
+    for (int m = 0; m < 4; ++m)
+    {
+        const bool useAcceleration = m >= 2;
+        const bool filterRect = (m % 2) != 0;
+
+        const double perTrackTime = RunFrames(tracks, useAcceleration, filterRect, frames, false);
+        const double batchTime = RunFrames(tracks, useAcceleration, filterRect, frames, true);
+        std::cout << std::setw(12) << names[m] << std::setw(16) << std::fixed << std::setprecision(1) << perTrackTime
+                  << std::setw(12) << batchTime << std::endl;
+    }
+    return 0;
+}
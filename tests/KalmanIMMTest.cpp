@@ -0,0 +1,133 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include "Kalman.h"
+
+///
+/// \brief The PathErrors struct
+///
+struct PathErrors
+{
+    double m_prediction = 0; // Mean distance between the predicted and the true position
+    double m_velocity = 0;   // Mean distance between the estimated and the true velocity per frame
+    double m_coverage = 0;   // Part of the frames with the true position inside the 3 sigma ellipse of the predicted position covariance
+    double m_gateArea = 0;   // Mean area of the 3 sigma ellipse
+};
+
+///
+/// \brief RunPath
+/// Synthetic path with the constant speed cruise, braking, turn and acceleration phases (50 frames each) and the Gaussian measurement noise
+/// \param type
+/// \param useAcceleration
+/// \param filterRect
+/// \return
+///
+PathErrors RunPath(tracking::KalmanType type, bool useAcceleration, bool filterRect)
+{
+    const track_t deltaTime = 0.2f;
+    TKalmanFilter filter(type, useAcceleration, filterRect, deltaTime, 0.5f);
+
+    std::mt19937 gen(1);
+    std::normal_distribution<float> noise(0.f, 0.5f);
+
+    double x = 0;
+    double y = 0;
+    double vx = 10;
+    double vy = 0;
+
+    PathErrors errors;
+    int count = 0;
+    const int framesCount = 400;
+    const int skipFrames = 10; // Filter initialization
+    for (int frame = 0; frame < framesCount; ++frame)
+    {
+        double ax = 0;
+        double ay = 0;
+        switch ((frame / 50) % 4)
+        {
+        case 1: ax = -0.15; break;
+        case 2: ay = 0.2; break;
+        case 3: ax = 0.15; break;
+        }
+        vx += ax;
+        vy += ay;
+        x += vx;
+        y += vy;
+
+        Point_t prediction;
+        if (filterRect)
+        {
+            cv::Rect rect = filter.GetRectPrediction();
+            prediction = Point_t(static_cast<track_t>(rect.x), static_cast<track_t>(rect.y));
+        }
+        else
+        {
+            prediction = filter.GetPointPrediction();
+        }
+        if (frame > skipFrames)
+        {
+            errors.m_prediction += std::hypot(prediction.x - x, prediction.y - y);
+            cv::Vec<track_t, 2> velocity = filter.GetVelocity();
+            errors.m_velocity += std::hypot(velocity[0] * deltaTime - vx, velocity[1] * deltaTime - vy);
+
+            // Mahalanobis distance of the true position: d^T * cov^-1 * d <= 3^2
+            const cv::Matx<track_t, 2, 2> cov = filter.GetPositionCov();
+            const double det = static_cast<double>(cov(0, 0)) * cov(1, 1) - static_cast<double>(cov(0, 1)) * cov(1, 0);
+            const double dx = prediction.x - x;
+            const double dy = prediction.y - y;
+            if (det > 0 && (cov(1, 1) * dx * dx - (cov(0, 1) + cov(1, 0)) * dx * dy + cov(0, 0) * dy * dy) / det <= 9)
+                errors.m_coverage += 1;
+            errors.m_gateArea += 9 * CV_PI * std::sqrt(std::max(det, 0.));
+            ++count;
+        }
+
+        if (filterRect)
+            filter.Update(cv::Rect(static_cast<int>(x + noise(gen)), static_cast<int>(y + noise(gen)), 20, 20), true);
+        else
+            filter.Update(Point_t(static_cast<track_t>(x + noise(gen)), static_cast<track_t>(y + noise(gen))), true);
+    }
+    errors.m_prediction /= count;
+    errors.m_velocity /= count;
+    errors.m_coverage /= count;
+    errors.m_gateArea /= count;
+    return errors;
+}
+
+///
+/// \brief main
+/// The constant acceleration and IMM filters must follow the manoeuvres and be better than the constant velocity filter.
+/// On this path the constant acceleration model is exact between the manoeuvres, so CA has a bit smaller prediction error,
+/// but the IMM mixed covariance used in the prediction ellipse must cover the true position not worse than the CA covariance
+/// \return 0 on success
+///
+int main(int /*argc*/, char** /*argv*/)
+{
+    int res = 0;
+    for (bool filterRect : { false, true })
+    {
+        const PathErrors cvErrors = RunPath(tracking::KalmanLinear, false, filterRect);
+        const PathErrors caErrors = RunPath(tracking::KalmanLinear, true, filterRect);
+        const PathErrors immErrors = RunPath(tracking::KalmanIMM, false, filterRect);
+
+        // The measurement noise sigma is 0.5 px, rect coordinates are rounded to int
+        const double maxPredictionError = filterRect ? 2.5 : 1.5;
+        const double maxVelocityError = 1.0;
+
+        auto Check = [&](const char* name, const PathErrors& errors, bool better)
+        {
+            const bool ok = std::isfinite(errors.m_prediction) && errors.m_prediction < maxPredictionError &&
+                    errors.m_velocity < maxVelocityError && better;
+            std::cout << (filterRect ? "rect " : "point ") << name << ": prediction error " << std::fixed << std::setprecision(3) << errors.m_prediction
+                      << ", velocity error " << errors.m_velocity << ", coverage " << errors.m_coverage << ", gate area " << errors.m_gateArea << (ok ? " - ok" : " - FAILED") << std::endl;
+            if (!ok)
+                res = 1;
+        };
+        std::cout << (filterRect ? "rect " : "point ") << "CV: prediction error " << std::fixed << std::setprecision(3) << cvErrors.m_prediction
+                  << ", velocity error " << cvErrors.m_velocity << ", coverage " << cvErrors.m_coverage << ", gate area " << cvErrors.m_gateArea << std::endl;
+        Check("CA", caErrors, caErrors.m_prediction < cvErrors.m_prediction);
+        Check("IMM", immErrors, immErrors.m_prediction < cvErrors.m_prediction && immErrors.m_coverage >= caErrors.m_coverage);
+    }
+    return res;
+}
@@ -0,0 +1,44 @@
+#include <iostream>
+#include <cmath>
+#include "ShortPathCalculator.h"
+#include "AssignmentScene.h"
+
+///
+/// \brief main
+/// SPBipart on the gated 1080p scenes with maxCost = frame area must give the same gated cost as the exact SPSparseJV
+/// \return 0 on success
+///
+int main(int /*argc*/, char** /*argv*/)
+{
+    const size_t objectsCount[] = { 50, 200, 1000 };
+
+    int res = 0;
+    for (size_t objects : objectsCount)
+    {
+        AssignmentScene scene;
+        scene.Generate(objects, 12345);
+
+        SPSettings settings = { scene.m_distThres, 12 };
+        SPBipart bipart(settings);
+        SPSparseJV sparseJV(settings);
+
+        assignments_t bipartAssignment;
+        bipart.Solve(scene.m_costMatrix, scene.m_tracks, scene.m_regions, bipartAssignment, scene.m_maxPossibleCost);
+        assignments_t jvAssignment;
+        sparseJV.Solve(scene.m_costMatrix, scene.m_tracks, scene.m_regions, jvAssignment, scene.m_maxPossibleCost);
+
+        size_t bipartAssigned = 0;
+        const double bipartCost = scene.GatedCost(bipartAssignment, bipartAssigned);
+        size_t jvAssigned = 0;
+        const double jvCost = scene.GatedCost(jvAssignment, jvAssigned);
+
+        // SPBipart prefers the assignment by eps = 0.001 * m_distThres
+        const double tolerance = 1e-3 * scene.m_distThres * objects;
+        const bool ok = std::fabs(bipartCost - jvCost) <= tolerance;
+        std::cout << objects << " objects: Bipart " << bipartAssigned << " pairs, cost " << bipartCost
+                  << "; SparseJV " << jvAssigned << " pairs, cost " << jvCost << (ok ? " - ok" : " - FAILED") << std::endl;
+        if (!ok)
+            res = 1;
+    }
+    return res;
+}
@@ -0,0 +1,55 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include "SpatialGrid.h"
+#include "EllipseGate.h"
+
+///
+/// \brief main
+/// SpatialGrid::GateRect must keep all regions that can be closer than the maximal distance:
+/// the centers inside the prediction ellipse and the bounding rectangles intersected with the last track rectangle
+/// \return 0 on success
+///
+int main(int /*argc*/, char** /*argv*/)
+{
+    std::mt19937 gen(2024);
+    std::uniform_real_distribution<float> posDist(0.f, 1920.f);
+    std::uniform_real_distribution<float> sizeDist(5.f, 150.f);
+    std::uniform_real_distribution<float> angleDist(-90.f, 90.f);
+
+    // Regions from the rectangles and from the rotated rectangles: their bounding rectangles are not concentric with the rrect centers
+    regions_t regions;
+    for (int i = 0; i < 2000; ++i)
+    {
+        if (i % 2)
+            regions.emplace_back(cv::Rect(cvRound(posDist(gen)), cvRound(posDist(gen) * 0.5625f), cvRound(sizeDist(gen)), cvRound(sizeDist(gen))));
+        else
+            regions.emplace_back(cv::RotatedRect(cv::Point2f(posDist(gen), posDist(gen) * 0.5625f), cv::Size2f(sizeDist(gen), sizeDist(gen)), angleDist(gen)));
+    }
+    SpatialGrid grid;
+    grid.Build(regions);
+
+    size_t lost = 0;
+    size_t candidates = 0;
+    std::vector<int> gateRegions;
+    for (int i = 0; i < 500; ++i)
+    {
+        const cv::Rect lastRect(cvRound(posDist(gen)), cvRound(posDist(gen) * 0.5625f), cvRound(sizeDist(gen)), cvRound(sizeDist(gen)));
+        // Angle in radians like in CTrack::CalcPredictionEllipse
+        const cv::RotatedRect predictedArea(cv::Point2f(lastRect.x + 0.5f * lastRect.width, lastRect.y + 0.5f * lastRect.height),
+                                            cv::Size2f(sizeDist(gen), sizeDist(gen)), angleDist(gen) * static_cast<float>(CV_PI) / 180.f);
+        const EllipseGate ellipse(predictedArea);
+
+        grid.Query(grid.GateRect(predictedArea, lastRect, true), gateRegions);
+        candidates += gateRegions.size();
+
+        for (size_t j = 0; j < regions.size(); ++j)
+        {
+            const bool near = ellipse.Dist(regions[j].m_rrect.center) <= 1 || (lastRect & regions[j].m_brect).area() > 0;
+            if (near && !std::binary_search(gateRegions.begin(), gateRegions.end(), static_cast<int>(j)))
+                ++lost;
+        }
+    }
+    std::cout << "Regions in the gates: " << candidates << ", lost near regions: " << lost << (lost ? " - FAILED" : " - ok") << std::endl;
+    return lost ? 1 : 0;
+}